@@ -0,0 +1,184 @@
+// 4000 sprites over 64 small images: a texture bind and a draw per sprite vs one atlas
+// (texture_atlas.h) bound once and every sprite in one draw with rewritten UVs.
+// Also prints pack time and occupancy of both packing heuristics.
+#include "bench_util.h"
+
+#include <shader_s.h>
+#include <texture_atlas.h>
+
+#include <cstdio>
+#include <vector>
+
+const int IMAGES = 64;
+const int SPRITES = 4000;
+const int FRAMES = 200;
+
+const char* VERTEX =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "layout (location = 1) in vec2 aTexCoord;\n"
+    "out vec2 TexCoord;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+    "    TexCoord = aTexCoord;\n"
+    "}\n";
+const char* FRAGMENT =
+    "#version 330 core\n"
+    "in vec2 TexCoord;\n"
+    "out vec4 FragColor;\n"
+    "uniform sampler2D image;\n"
+    "void main()\n"
+    "{\n"
+    "    FragColor = texture(image, TexCoord);\n"
+    "}\n";
+
+// 16 to 80 texels a side, a colour per image with a darker border
+static std::vector<MipImage> makeImages()
+{
+    std::vector<MipImage> images(IMAGES);
+    unsigned int seed = 99;
+    for (int i = 0; i < IMAGES; ++i)
+    {
+        MipImage& image = images[i];
+        seed = seed * 1664525u + 1013904223u;
+        image.width = 16 + (int)(seed >> 26);
+        seed = seed * 1664525u + 1013904223u;
+        image.height = 16 + (int)(seed >> 26);
+        image.channels = 4;
+        image.pixels.resize((size_t)image.width * image.height * 4);
+        for (int y = 0; y < image.height; ++y)
+            for (int x = 0; x < image.width; ++x)
+            {
+                unsigned char* p = &image.pixels[((size_t)y * image.width + x) * 4];
+                bool border = x < 2 || y < 2 || x >= image.width - 2 || y >= image.height - 2;
+                p[0] = (unsigned char)(i * 37 >> (border ? 1 : 0));
+                p[1] = (unsigned char)(i * 91 >> (border ? 1 : 0));
+                p[2] = (unsigned char)(i * 53 >> (border ? 1 : 0));
+                p[3] = 255;
+            }
+    }
+    return images;
+}
+
+static GLuint uploadTexture(const std::vector<MipImage>& levels)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    for (size_t i = 0; i < levels.size(); ++i)
+        glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA, levels[i].width, levels[i].height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     levels[i].pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+int main()
+{
+    std::vector<MipImage> images = makeImages();
+    for (PackHeuristic heuristic : {PackHeuristic::Skyline, PackHeuristic::MaxRects})
+    {
+        AtlasOptions options;
+        options.pageSize = 512;
+        options.heuristic = heuristic;
+        Stopwatch timer;
+        Atlas atlas = buildAtlas(images, options);
+        std::printf("%s: packed in %.2f ms (mips included)\n", heuristic == PackHeuristic::Skyline ? "skyline" : "maxrects",
+                    timer.milliseconds());
+        atlas.report();
+    }
+
+    GLFWwindow* window = createBenchContext(512, 512);
+    if (window == NULL)
+        return -1;
+    glViewport(0, 0, 512, 512);
+    Shader shader = Shader::fromSource(VERTEX, FRAGMENT);
+    shader.use();
+    glUniform1i(glGetUniformLocation(shader.ID, "image"), 0);
+
+    std::vector<GLuint> textures;
+    for (const MipImage& image : images)
+        textures.push_back(uploadTexture(buildMipChain(image)));
+    AtlasOptions options;
+    options.pageSize = 512;
+    Atlas atlas = buildAtlas(images, options);
+    if (atlas.pages.size() != 1)
+    {
+        std::printf("the images need %zu pages, the bench expects 1\n", atlas.pages.size());
+        return -1;
+    }
+    GLuint atlasTexture = uploadTexture(atlas.pages[0]);
+
+    // two triangles per sprite, position + uv
+    std::vector<float> vertices;
+    unsigned int seed = 7;
+    for (int i = 0; i < SPRITES; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float x = (seed >> 8) / 16777216.0f * 1.9f - 1.0f;
+        seed = seed * 1664525u + 1013904223u;
+        float y = (seed >> 8) / 16777216.0f * 1.9f - 1.0f;
+        const float s = 0.05f;
+        const float quad[6][4] = {{x, y, 0, 0}, {x + s, y, 1, 0}, {x + s, y + s, 1, 1},
+                                  {x, y, 0, 0}, {x + s, y + s, 1, 1}, {x, y + s, 0, 1}};
+        for (const auto& vertex : quad)
+            vertices.insert(vertices.end(), vertex, vertex + 4);
+    }
+    std::vector<float> atlasVertices = vertices;
+    for (int i = 0; i < SPRITES; ++i)
+        rewriteUVs(atlasVertices.data() + (size_t)i * 6 * 4, 6, 4, 2, atlas.entries[i % IMAGES]);
+
+    GLuint VAO[2], VBO[2];
+    glGenVertexArrays(2, VAO);
+    glGenBuffers(2, VBO);
+    for (int i = 0; i < 2; ++i)
+    {
+        const std::vector<float>& data = i == 0 ? vertices : atlasVertices;
+        glBindVertexArray(VAO[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+    }
+
+    auto drawSeparate = [&] {
+        glBindVertexArray(VAO[0]);
+        for (int i = 0; i < SPRITES; ++i)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[i % IMAGES]);
+            glDrawArrays(GL_TRIANGLES, i * 6, 6);
+        }
+    };
+    auto drawAtlas = [&] {
+        glBindVertexArray(VAO[1]);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glDrawArrays(GL_TRIANGLES, 0, SPRITES * 6);
+    };
+    auto run = [&](const char* label, auto&& draw) {
+        draw();
+        glFinish();
+        Stopwatch timer;
+        for (int frame = 0; frame < FRAMES; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            draw();
+            glFinish();
+        }
+        std::printf("%-28s %8.3f ms/frame (%d sprites)\n", label, timer.milliseconds() / FRAMES, SPRITES);
+    };
+    run("bind + draw per sprite", drawSeparate);
+    run("atlas, one draw", drawAtlas);
+
+    glDeleteTextures((GLsizei)textures.size(), textures.data());
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteVertexArrays(2, VAO);
+    glDeleteBuffers(2, VBO);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,90 @@
+// block compression (block_compression.h) on the CPU: encode time on one thread and
+// on the pool, and the PSNR of the decoded result, for the demo textures and a
+// synthetic 2K RGBA image. No GL context needed.
+// usage: bc_bench [images...]   (default: resources/textures/1.jpg and 2.png)
+#include "bench_util.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <block_compression.h>
+#include <thread_pool.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static MipImage loadImage(const std::string& path)
+{
+    MipImage image;
+    unsigned char* pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (pixels)
+        image.pixels.assign(pixels, pixels + (size_t)image.width * image.height * image.channels);
+    stbi_image_free(pixels);
+    return image;
+}
+
+static MipImage makeImage(int size)
+{
+    MipImage image;
+    image.width = image.height = size;
+    image.channels = 4;
+    image.pixels.resize((size_t)size * size * 4);
+    for (int y = 0; y < size; ++y)
+        for (int x = 0; x < size; ++x)
+        {
+            unsigned char* p = image.pixels.data() + ((size_t)y * size + x) * 4;
+            // smooth gradients, a sharp edge every 37 texels and a soft alpha ramp
+            p[0] = (unsigned char)(x * 255 / size);
+            p[1] = (unsigned char)(y * 255 / size);
+            p[2] = (unsigned char)(((x + y) % 37) < 18 ? 40 : 220);
+            p[3] = (unsigned char)((x * 7 + y * 3) & 255);
+        }
+    return image;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::pair<std::string, MipImage>> images;
+    if (argc > 1)
+        for (int i = 1; i < argc; ++i)
+            images.push_back({argv[i], loadImage(argv[i])});
+    else
+    {
+        images.push_back({"1.jpg", loadImage(OPENGLTUTOR_HOME "resources/textures/1.jpg")});
+        images.push_back({"2.png", loadImage(OPENGLTUTOR_HOME "resources/textures/2.png")});
+    }
+    images.push_back({"synthetic 2048", makeImage(2048)});
+
+    ThreadPool pool;
+    std::printf("pool: %zu worker threads + caller\n", pool.size());
+    const std::pair<const char*, BlockFormat> formats[] = {
+        {"BC1", BlockFormat::BC1}, {"BC3", BlockFormat::BC3}, {"BC7", BlockFormat::BC7}};
+    for (const auto& entry : images)
+    {
+        const MipImage& image = entry.second;
+        if (image.pixels.empty())
+        {
+            std::printf("%s: cannot load\n", entry.first.c_str());
+            continue;
+        }
+        for (const auto& format : formats)
+        {
+            Stopwatch timer;
+            std::vector<unsigned char> single = compressImage(image, format.second);
+            double singleMs = timer.milliseconds();
+            timer.reset();
+            std::vector<unsigned char> pooled = compressImage(image, format.second, &pool);
+            double pooledMs = timer.milliseconds();
+            MipImage decoded = decompressImage(pooled.data(), image.width, image.height, format.second);
+            double megapixels = (double)image.width * image.height / 1e6;
+            std::printf("%-16s %4dx%-4d x%d %s  1 thread %8.1f ms (%6.1f Mpx/s)  pool %7.1f ms (%6.1f Mpx/s)  "
+                        "%7zu -> %6zu bytes  PSNR %5.2f dB%s\n",
+                        entry.first.c_str(), image.width, image.height, image.channels, format.first,
+                        singleMs, megapixels / singleMs * 1e3, pooledMs, megapixels / pooledMs * 1e3,
+                        image.pixels.size(), pooled.size(), psnr(image, decoded),
+                        single == pooled ? "" : "  MISMATCH between 1 thread and pool");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// shared helpers for the programs in bench/: a hidden 3.3 core context and a wall clock timer
+// ------------------------------------------------------------------------
+inline GLFWwindow* createBenchContext(int width = 64, int height = 64)
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, 0);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    GLFWwindow* window = glfwCreateWindow(width, height, "bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return NULL;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        glfwTerminate();
+        return NULL;
+    }
+    std::cout << "GL_RENDERER: " << glGetString(GL_RENDERER) << "\n"
+              << "GL_VERSION:  " << glGetString(GL_VERSION) << std::endl;
+    return window;
+}
+
+// write a generated shader next to the executable so it can go through Shader(path, path)
+inline std::string writeBenchFile(const std::string& path, const std::string& contents)
+{
+    std::ofstream(path, std::ios::binary) << contents;
+    return path;
+}
+
+class Stopwatch
+{
+public:
+    Stopwatch() : start(std::chrono::steady_clock::now()) {}
+    void reset() { start = std::chrono::steady_clock::now(); }
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    double milliseconds() const { return seconds() * 1000.0; }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
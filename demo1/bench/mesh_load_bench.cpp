@@ -0,0 +1,131 @@
+// mesh import (mesh_loader.h): a getline / istringstream / std::unordered_map OBJ reader,
+// as tools/meshopt.cpp has, against the mapped loader on one thread and on all of them.
+// Without a path a terrain OBJ of the given size is generated next to the executable.
+// No GL context needed.
+// usage: mesh_load_bench [MiB to generate, default 256 | file.obj | file.glb]
+#include "bench_util.h"
+
+#include <mesh_loader.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a square grid of "v x y z r g b" and "vt u v" with quads sharing corners, about `megabytes` large
+static std::string generateObj(size_t megabytes)
+{
+    const std::string path = "mesh_load_bench.obj";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return path;
+    // ~100 bytes of v and vt and ~50 bytes of f per grid point
+    int grid = 2;
+    while ((size_t)grid * grid * 150 < megabytes << 20)
+        grid += 16;
+    std::string text;
+    char line[160];
+    auto flush = [&](bool force) {
+        if (force || text.size() > (1 << 22))
+        {
+            std::fwrite(text.data(), 1, text.size(), file);
+            text.clear();
+        }
+    };
+    for (int y = 0; y < grid; ++y)
+        for (int x = 0; x < grid; ++x)
+        {
+            const float u = (float)x / (grid - 1), v = (float)y / (grid - 1);
+            const float height = 0.04f * std::sin(u * 40.0f) * std::cos(v * 31.0f);
+            text.append(line, std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f %.4f %.4f %.4f\nvt %.6f %.6f\n",
+                                            u * 2.0f - 1.0f, height, v * 2.0f - 1.0f, u, v, 0.5f + height * 10.0f,
+                                            u * 8.0f, v * 8.0f));
+            flush(false);
+        }
+    for (int y = 0; y + 1 < grid; ++y)
+        for (int x = 0; x + 1 < grid; ++x)
+        {
+            const int a = y * grid + x + 1, b = a + 1, c = a + grid + 1, d = a + grid;
+            text.append(line, std::snprintf(line, sizeof(line), "f %d/%d %d/%d %d/%d %d/%d\n", a, a, b, b, c, c, d, d));
+            flush(false);
+        }
+    flush(true);
+    std::fclose(file);
+    return path;
+}
+
+// the iostream way: counts only, for the comparison
+static bool readObjStreams(const std::string& path, size_t& vertexCount, size_t& indexCount)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::vector<float> positions, texCoords;
+    std::unordered_map<std::string, uint32_t> welded;
+    std::vector<uint32_t> indices;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream in(line);
+        std::string tag;
+        in >> tag;
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        if (tag == "v" && in >> x >> y >> z)
+            positions.insert(positions.end(), {x, y, z});
+        else if (tag == "vt" && in >> x >> y)
+            texCoords.insert(texCoords.end(), {x, y});
+        else if (tag == "f")
+        {
+            std::vector<uint32_t> polygon;
+            std::string corner;
+            while (in >> corner)
+                polygon.push_back(welded.emplace(corner, (uint32_t)welded.size()).first->second);
+            for (size_t i = 2; i < polygon.size(); ++i)
+                indices.insert(indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+        }
+    }
+    vertexCount = welded.size();
+    indexCount = indices.size();
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = argc > 1 ? argv[1] : "256";
+    if (path.find_first_not_of("0123456789") == std::string::npos)
+    {
+        Stopwatch timer;
+        path = generateObj(std::strtoul(path.c_str(), nullptr, 10));
+        std::printf("generated %s in %.1f s\n", path.c_str(), timer.seconds());
+    }
+
+    const bool obj = path.size() > 4 && path.compare(path.size() - 4, 4, ".obj") == 0;
+    if (obj)
+    {
+        Stopwatch timer;
+        size_t vertexCount = 0, indexCount = 0;
+        if (readObjStreams(path, vertexCount, indexCount))
+            std::printf("%-22s %9.1f ms  %zu vertices, %zu triangles\n", "iostream", timer.milliseconds(),
+                        vertexCount, indexCount / 3);
+    }
+
+    LoadedMesh serial = loadMesh(path);
+    if (!serial.valid)
+        return 1;
+    std::printf("%-22s ", "mapped, 1 thread");
+    serial.report();
+
+    ThreadPool pool;
+    LoadedMesh threaded = loadMesh(path, &pool);
+    char label[32];
+    std::snprintf(label, sizeof(label), "mapped, %zu threads", pool.size() + 1);
+    std::printf("%-22s ", label);
+    threaded.report();
+    std::printf("speedup %.2fx, output %s\n", serial.totalMs / threaded.totalMs,
+                serial.vertices == threaded.vertices && serial.indices == threaded.indices ? "identical" : "DIFFERS");
+    return 0;
+}
@@ -0,0 +1,94 @@
+// post-decode stage (post_decode.h): flip + RGB->RGBA + premultiply as separate passes
+// over the image (what stb's flip flag plus later conversions amount to) vs one fused
+// sweep, scalar and SIMD, on 4K images. No GL context needed.
+#include "bench_util.h"
+
+#include <post_decode.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+const int SIZE = 4096;
+const int REPEATS = 10;
+
+// the separate passes: row swap in place, expansion into a new buffer, premultiply in place
+static std::vector<unsigned char> separatePasses(std::vector<unsigned char> pixels, int channels, bool premultiply,
+                                                 double stageMs[3])
+{
+    Stopwatch timer;
+    const size_t row = (size_t)SIZE * channels;
+    std::vector<unsigned char> swap(row);
+    for (int y = 0; y < SIZE / 2; ++y)
+    {
+        unsigned char* top = pixels.data() + y * row;
+        unsigned char* bottom = pixels.data() + (SIZE - 1 - y) * row;
+        std::memcpy(swap.data(), top, row);
+        std::memcpy(top, bottom, row);
+        std::memcpy(bottom, swap.data(), row);
+    }
+    stageMs[0] += timer.milliseconds();
+
+    timer.reset();
+    std::vector<unsigned char> rgba((size_t)SIZE * SIZE * 4);
+    for (size_t i = 0; i < (size_t)SIZE * SIZE; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+            rgba[i * 4 + k] = pixels[i * channels + k];
+        rgba[i * 4 + 3] = channels == 4 ? pixels[i * channels + 3] : 255;
+    }
+    stageMs[1] += timer.milliseconds();
+
+    timer.reset();
+    if (premultiply)
+        for (size_t i = 0; i < (size_t)SIZE * SIZE; ++i)
+            for (int k = 0; k < 3; ++k)
+                rgba[i * 4 + k] = post_decode_detail::multiply255(rgba[i * 4 + k], rgba[i * 4 + 3]);
+    stageMs[2] += timer.milliseconds();
+    return rgba;
+}
+
+int main()
+{
+    for (int channels : {3, 4})
+    {
+        std::vector<unsigned char> decoded((size_t)SIZE * SIZE * channels);
+        unsigned int seed = 1;
+        for (unsigned char& value : decoded)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            value = (unsigned char)(seed >> 24);
+        }
+        const bool premultiply = channels == 4;
+
+        double stageMs[3] = {};
+        std::vector<unsigned char> reference;
+        Stopwatch timer;
+        for (int i = 0; i < REPEATS; ++i)
+            reference = separatePasses(decoded, channels, premultiply, stageMs);
+        double separateMs = timer.milliseconds() / REPEATS;
+
+        PostDecodeOptions options;
+        options.flipVertically = true;
+        options.outputChannels = 4;
+        options.premultiplyAlpha = premultiply;
+        double fusedMs[2];
+        bool same = true;
+        for (int simd = 0; simd < 2; ++simd)
+        {
+            options.simd = simd == 1;
+            MipImage fused;
+            timer.reset();
+            for (int i = 0; i < REPEATS; ++i)
+                fused = postDecode(decoded.data(), SIZE, SIZE, channels, options);
+            fusedMs[simd] = timer.milliseconds() / REPEATS;
+            same = same && fused.pixels == reference;
+        }
+        std::printf("%dx%d %s -> RGBA%s\n", SIZE, SIZE, channels == 3 ? "RGB" : "RGBA", premultiply ? " premultiplied" : "");
+        std::printf("  separate passes %7.2f ms  (flip %.2f, expand %.2f, premultiply %.2f; includes the input copy)\n",
+                    separateMs, stageMs[0] / REPEATS, stageMs[1] / REPEATS, stageMs[2] / REPEATS);
+        std::printf("  fused scalar    %7.2f ms\n  fused simd      %7.2f ms  %s\n", fusedMs[0], fusedMs[1],
+                    same ? "(results identical)" : "RESULTS DIFFER");
+    }
+    return 0;
+}
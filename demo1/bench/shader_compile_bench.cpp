@@ -0,0 +1,94 @@
+// startup cost of building every program in shader/: one blocking Shader after the other
+// vs submitting all of them with Shader::deferred and waiting only when they are used
+// set MESA_SHADER_CACHE_DISABLE=true (or the vendor's equivalent) to keep the driver's disk cache out of it
+#include "bench_util.h"
+
+#include <shader_files.h>
+#include <shader_preprocessor.h>
+#include <shader_s.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+const int ROUNDS = 20;
+
+int main()
+{
+    GLFWwindow* window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    glext::load((GLADloadproc)glfwGetProcAddress);
+    std::printf("parallel shader compile: %s\n", glext::functions().parallelShaderCompile ? "yes" : "no");
+
+    // pair name.vs with name.fs, includes resolved up front so only compiling is timed
+    ShaderFileSet files(OPENGLTUTOR_HOME "shader");
+    ShaderPreprocessor preprocessor([&](const std::string& name) { return files.find(name); });
+    std::map<std::string, std::pair<std::string, std::string>> pairs;
+    for (const auto& entry : std::filesystem::directory_iterator(OPENGLTUTOR_HOME "shader"))
+    {
+        std::string stem = entry.path().stem().string();
+        if (entry.path().extension() == ".vs")
+            pairs[stem].first = entry.path().filename().string();
+        else if (entry.path().extension() == ".fs")
+            pairs[stem].second = entry.path().filename().string();
+    }
+    std::vector<std::pair<std::string_view, std::string_view>> programs;
+    for (const auto& pair : pairs)
+        if (!pair.second.first.empty() && !pair.second.second.empty())
+            programs.push_back({preprocessor.expand(pair.second.first).text, preprocessor.expand(pair.second.second).text});
+    std::printf("%d programs in %sshader\n", (int)programs.size(), OPENGLTUTOR_HOME);
+
+    // every round gets its own define so the driver cannot reuse an earlier compile
+    int round = 0;
+    auto nextDefines = [&]() { return "#define BENCH_ROUND " + std::to_string(round++) + "\n"; };
+
+    double blockingMs = 0.0, deferredMs = 0.0, firstUseMs = 0.0;
+    int polls = 0;
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        // blocking constructor
+        {
+            std::string defines = nextDefines();
+            Stopwatch timer;
+            std::vector<unsigned int> ids;
+            for (const auto& program : programs)
+                ids.push_back(Shader::fromSource(program.first, program.second, nullptr, defines).ID);
+            glFinish();
+            blockingMs += timer.milliseconds();
+            for (unsigned int id : ids)
+                glDeleteProgram(id);
+        }
+        // submit all, poll, then use
+        {
+            std::string defines = nextDefines();
+            Stopwatch timer;
+            std::vector<Shader> shaders;
+            for (const auto& program : programs)
+                shaders.push_back(Shader::deferredFromSource(program.first, program.second, nullptr, defines));
+            bool ready = false;
+            while (!ready)
+            {
+                ready = true;
+                for (const Shader& shader : shaders)
+                    ready = ready && shader.isReady();
+                ++polls;
+            }
+            Stopwatch useTimer;
+            for (Shader& shader : shaders)
+                shader.use();
+            glFinish();
+            firstUseMs += useTimer.milliseconds();
+            deferredMs += timer.milliseconds();
+            for (const Shader& shader : shaders)
+                glDeleteProgram(shader.ID);
+        }
+    }
+    std::printf("blocking:  %8.3f ms per %d programs\n", blockingMs / ROUNDS, (int)programs.size());
+    std::printf("deferred:  %8.3f ms per %d programs (%.3f ms of it in first use, %.1f polls)\n",
+                deferredMs / ROUNDS, (int)programs.size(), firstUseMs / ROUNDS, (double)polls / ROUNDS);
+
+    glfwTerminate();
+    return 0;
+}
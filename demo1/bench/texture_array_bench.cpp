@@ -0,0 +1,185 @@
+// 10k quads with 64 distinct 64x64 images: a bind and a draw per quad vs one texture
+// array (texture_array.h, shader/texture_array.vs/fs) with the layer per instance in
+// one instanced draw, or per vertex in one plain draw.
+#include "bench_util.h"
+
+#include <shader_s.h>
+#include <texture_array.h>
+
+#include <cstdio>
+#include <vector>
+
+const int IMAGES = 64;
+const int IMAGE_SIZE = 64;
+const int QUADS = 10000;
+const int FRAMES = 200;
+
+static std::vector<MipImage> makeImages()
+{
+    std::vector<MipImage> images(IMAGES);
+    for (int i = 0; i < IMAGES; ++i)
+    {
+        MipImage& image = images[i];
+        image.width = image.height = IMAGE_SIZE;
+        image.channels = 4;
+        image.pixels.resize((size_t)IMAGE_SIZE * IMAGE_SIZE * 4);
+        for (int y = 0; y < IMAGE_SIZE; ++y)
+            for (int x = 0; x < IMAGE_SIZE; ++x)
+            {
+                unsigned char* p = &image.pixels[((size_t)y * IMAGE_SIZE + x) * 4];
+                bool checker = ((x / 8) ^ (y / 8)) & 1;
+                p[0] = (unsigned char)(i * 37);
+                p[1] = (unsigned char)(checker ? i * 91 : 255 - i * 91);
+                p[2] = (unsigned char)(i * 53);
+                p[3] = 255;
+            }
+    }
+    return images;
+}
+
+static void runBench()
+{
+    std::vector<MipImage> images = makeImages();
+    ThreadPool pool;
+    Stopwatch timer;
+    TextureArray array(images, MipOptions(), &pool);
+    std::printf("texture array: %d layers of %dx%d, %d levels, built in %.2f ms\n", array.layers(), array.width(),
+                array.height(), array.levels(), timer.milliseconds());
+    std::vector<GLuint> textures(IMAGES);
+    glGenTextures(IMAGES, textures.data());
+    for (int i = 0; i < IMAGES; ++i)
+    {
+        std::vector<MipImage> chain = buildMipChain(images[i]);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        for (size_t level = 0; level < chain.size(); ++level)
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGBA8, chain[level].width, chain[level].height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, chain[level].pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)chain.size() - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    }
+
+    Shader arrayShader(OPENGLTUTOR_HOME "shader/texture_array.vs", OPENGLTUTOR_HOME "shader/texture_array.fs");
+    arrayShader.use();
+    glUniform1i(glGetUniformLocation(arrayShader.ID, "textures"), 0);
+    const std::string single = writeBenchFile("texture_array_bench_single.fs",
+                                              "#version 330 core\n"
+                                              "out vec4 FragColor;\n"
+                                              "in vec3 TexCoord;\n"
+                                              "uniform sampler2D image;\n"
+                                              "void main()\n"
+                                              "{\n"
+                                              "    FragColor = texture(image, TexCoord.xy);\n"
+                                              "}\n");
+    Shader singleShader(OPENGLTUTOR_HOME "shader/texture_array.vs", single.c_str());
+    singleShader.use();
+    glUniform1i(glGetUniformLocation(singleShader.ID, "image"), 0);
+
+    // one unit quad (position, uv) and per quad an offset, a scale and a layer
+    const float quad[6][5] = {{0, 0, 0, 0, 0}, {1, 0, 0, 1, 0}, {1, 1, 0, 1, 1},
+                              {0, 0, 0, 0, 0}, {1, 1, 0, 1, 1}, {0, 1, 0, 0, 1}};
+    std::vector<float> instances; // x, y, scale, layer
+    unsigned int seed = 5;
+    for (int i = 0; i < QUADS; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float x = (seed >> 8) / 16777216.0f * 1.95f - 1.0f;
+        seed = seed * 1664525u + 1013904223u;
+        float y = (seed >> 8) / 16777216.0f * 1.95f - 1.0f;
+        instances.insert(instances.end(), {x, y, 0.04f, (float)(i % IMAGES)});
+    }
+    // the same quads pre-transformed, layer per vertex: x, y, z, u, v, layer
+    std::vector<float> vertices;
+    for (int i = 0; i < QUADS; ++i)
+        for (const auto& corner : quad)
+        {
+            const float* instance = &instances[(size_t)i * 4];
+            vertices.insert(vertices.end(), {corner[0] * instance[2] + instance[0], corner[1] * instance[2] + instance[1],
+                                             0.0f, corner[3], corner[4], instance[3]});
+        }
+
+    GLuint VAO[2], VBO[3];
+    glGenVertexArrays(2, VAO);
+    glGenBuffers(3, VBO);
+    // VAO[0]: instanced
+    glBindVertexArray(VAO[0]);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO[1]);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(float), instances.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+    // VAO[1]: per vertex, the offset/scale attribute stays a constant
+    glBindVertexArray(VAO[1]);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO[2]);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(4);
+    glVertexAttrib3f(3, 0.0f, 0.0f, 1.0f);
+
+    auto drawSeparate = [&] {
+        singleShader.use();
+        glBindVertexArray(VAO[1]);
+        glVertexAttrib3f(3, 0.0f, 0.0f, 1.0f);
+        for (int i = 0; i < QUADS; ++i)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[i % IMAGES]);
+            glDrawArrays(GL_TRIANGLES, i * 6, 6);
+        }
+    };
+    auto drawInstanced = [&] {
+        arrayShader.use();
+        array.bind(0);
+        glBindVertexArray(VAO[0]);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, QUADS);
+    };
+    auto drawPerVertex = [&] {
+        arrayShader.use();
+        array.bind(0);
+        glBindVertexArray(VAO[1]);
+        glVertexAttrib3f(3, 0.0f, 0.0f, 1.0f);
+        glDrawArrays(GL_TRIANGLES, 0, QUADS * 6);
+    };
+    auto run = [&](const char* label, auto&& draw) {
+        draw();
+        glFinish();
+        Stopwatch timer;
+        for (int frame = 0; frame < FRAMES; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            draw();
+            glFinish();
+        }
+        std::printf("%-32s %8.3f ms/frame (%d quads, %d images)\n", label, timer.milliseconds() / FRAMES, QUADS, IMAGES);
+    };
+    run("bind + draw per quad", drawSeparate);
+    run("array, layer per instance", drawInstanced);
+    run("array, layer per vertex", drawPerVertex);
+
+    glDeleteTextures(IMAGES, textures.data());
+    glDeleteVertexArrays(2, VAO);
+    glDeleteBuffers(3, VBO);
+}
+
+int main()
+{
+    GLFWwindow* window = createBenchContext(512, 512);
+    if (window == NULL)
+        return -1;
+    glext::load((GLADloadproc)glfwGetProcAddress); // glTexStorage3D when there is one
+    glViewport(0, 0, 512, 512);
+    runBench(); // the GL objects it owns are gone before the context
+    glfwTerminate();
+    return 0;
+}
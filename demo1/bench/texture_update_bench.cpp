@@ -0,0 +1,64 @@
+// streaming part of a texture every frame: respecifying the whole mutable texture with
+// glTexImage2D vs a Texture2D (texture_2d.h, immutable storage when available) updated
+// with glTexSubImage2D, whole level and a 256x256 region read in place through
+// GL_UNPACK_ROW_LENGTH. The odd RGB width needs the unpack alignment handled.
+#include "bench_util.h"
+
+#include <texture_2d.h>
+
+#include <cstdio>
+#include <vector>
+
+const int WIDTH = 1021; // RGB rows of 3063 bytes, not 4 byte aligned
+const int HEIGHT = 1024;
+const int REGION = 256;
+const int FRAMES = 300;
+
+static void runBench()
+{
+    MipImage image;
+    image.width = WIDTH;
+    image.height = HEIGHT;
+    image.channels = 3;
+    image.pixels.resize((size_t)WIDTH * HEIGHT * 3);
+    for (size_t i = 0; i < image.pixels.size(); ++i)
+        image.pixels[i] = (unsigned char)(i * 7);
+
+    GLuint mutableTexture;
+    glGenTextures(1, &mutableTexture);
+    Texture2D texture(WIDTH, HEIGHT, texture_storage::sizedFormat(3), 1);
+    std::printf("Texture2D %dx%d RGB8, %s storage\n", WIDTH, HEIGHT, texture.isImmutable() ? "immutable" : "mutable");
+
+    auto run = [&](const char* label, auto&& update) {
+        update(0);
+        glFinish();
+        Stopwatch timer;
+        for (int frame = 0; frame < FRAMES; ++frame)
+            update(frame);
+        glFinish();
+        std::printf("%-36s %8.3f ms/frame\n", label, timer.milliseconds() / FRAMES);
+    };
+    run("glTexImage2D whole texture", [&](int) {
+        glBindTexture(GL_TEXTURE_2D, mutableTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WIDTH, HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    });
+    run("Texture2D::update whole level", [&](int) { texture.update(image); });
+    run("Texture2D::update 256x256 region", [&](int frame) {
+        int x = (frame * 37) % (WIDTH - REGION), y = (frame * 53) % (HEIGHT - REGION);
+        texture.update(image, x, y, REGION, REGION, 0, x, y);
+    });
+    glDeleteTextures(1, &mutableTexture);
+}
+
+int main()
+{
+    GLFWwindow* window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    glext::load((GLADloadproc)glfwGetProcAddress);
+    runBench();
+    glfwTerminate();
+    return 0;
+}
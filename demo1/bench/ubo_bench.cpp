@@ -0,0 +1,114 @@
+// per object uniforms for 1k draws per frame: glUniformMatrix4fv + glUniform4fv per object
+// vs one uniform buffer upload per frame and a glBindBufferRange per object
+#include "bench_util.h"
+
+#include <shader_s.h>
+#include <uniform_block.h>
+
+#include <cmath>
+#include <cstdio>
+
+const int OBJECTS = 1000;
+const int FRAMES = 300;
+
+#define OBJECT_UNIFORMS(FIELD) FIELD(Mat4, model) FIELD(Vec4, color)
+STD140_BLOCK(ObjectUniforms, OBJECT_UNIFORMS);
+
+const char* VERTEX_HEADER = "#version 330 core\n";
+const char* VERTEX_BODY =
+    "const vec2 corners[3] = vec2[3](vec2(-0.01, -0.01), vec2(0.01, -0.01), vec2(0.0, 0.01));\n"
+    "out vec4 vertexColor;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = model * vec4(corners[gl_VertexID], 0.0, 1.0);\n"
+    "    vertexColor = color;\n"
+    "}\n";
+const char* FRAGMENT =
+    "#version 330 core\n"
+    "in vec4 vertexColor;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    FragColor = vertexColor;\n"
+    "}\n";
+
+// a translation per object and a color that changes every frame
+void fillObject(ObjectUniforms& object, int index, int frame)
+{
+    float x = (index % 40) / 20.0f - 1.0f, y = (index / 40) / 12.5f - 1.0f;
+    for (int i = 0; i < 16; ++i)
+        object.model.value[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    object.model.value[12] = x;
+    object.model.value[13] = y;
+    float t = (float)(frame + index) * 0.01f;
+    object.color.value[0] = 0.5f + 0.5f * std::sin(t);
+    object.color.value[1] = 0.5f + 0.5f * std::cos(t);
+    object.color.value[2] = 0.5f;
+    object.color.value[3] = 1.0f;
+}
+
+int main()
+{
+    GLFWwindow* window = createBenchContext(256, 256);
+    if (window == NULL)
+        return -1;
+
+    std::string plainVertex = std::string(VERTEX_HEADER) + "uniform mat4 model;\nuniform vec4 color;\n" + VERTEX_BODY;
+    std::string blockVertex = std::string(VERTEX_HEADER) + ObjectUniforms::glsl("Object") + VERTEX_BODY;
+    Shader plain = Shader::fromSource(plainVertex, FRAGMENT);
+    Shader block = Shader::fromSource(blockVertex, FRAGMENT);
+    bindUniformBlock(block.ID, "Object", 0);
+    std::printf("generated block:\n%s", ObjectUniforms::glsl("Object").c_str());
+
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glViewport(0, 0, 256, 256);
+
+    std::vector<ObjectUniforms> objects(OBJECTS);
+    GLint modelLocation = glGetUniformLocation(plain.ID, "model");
+    GLint colorLocation = glGetUniformLocation(plain.ID, "color");
+
+    auto drawPlain = [&](int frame) {
+        plain.use();
+        for (int i = 0; i < OBJECTS; ++i)
+        {
+            fillObject(objects[i], i, frame);
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, objects[i].model.value);
+            glUniform4fv(colorLocation, 1, objects[i].color.value);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+    };
+    UniformBlock<ObjectUniforms> ubo(0, OBJECTS);
+    std::printf("UBO stride %d bytes, %d bytes per frame\n", (int)ubo.byteStride(), (int)(ubo.byteStride() * OBJECTS));
+    auto drawBlock = [&](int frame) {
+        block.use();
+        for (int i = 0; i < OBJECTS; ++i)
+            fillObject(ubo[i], i, frame);
+        ubo.upload();
+        for (int i = 0; i < OBJECTS; ++i)
+        {
+            ubo.bind(i);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+    };
+
+    auto run = [&](const char* label, auto&& draw) {
+        draw(0);
+        glFinish();
+        Stopwatch timer;
+        for (int frame = 0; frame < FRAMES; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            draw(frame);
+            glFinish();
+        }
+        std::printf("%-24s %8.3f ms/frame (%d objects)\n", label, timer.milliseconds() / FRAMES, OBJECTS);
+    };
+    run("glUniform per object", drawPlain);
+    run("UBO ranges", drawBlock);
+
+    glDeleteVertexArrays(1, &VAO);
+    glfwTerminate();
+    return 0;
+}
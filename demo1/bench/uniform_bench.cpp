@@ -0,0 +1,94 @@
+// uniform update cost: glGetUniformLocation by name vs the reflected uniform table
+// and its shadow copy; 10k uniform sets per frame, flush + glFinish at the end of every frame.
+// The table runs batch their uploads, the last one uploads every change at once
+#include "bench_util.h"
+
+#include <shader_s.h>
+
+#include <cstdio>
+#include <vector>
+
+const int UNIFORM_COUNT = 16;
+const int SETS_PER_FRAME = 10000;
+const int FRAMES = 200;
+
+int main()
+{
+    GLFWwindow* window = createBenchContext();
+    if (window == NULL)
+        return -1;
+
+    // a program with UNIFORM_COUNT float uniforms that are all kept active
+    std::string fragment = "#version 330 core\nout vec4 FragColor;\n";
+    for (int i = 0; i < UNIFORM_COUNT; ++i)
+        fragment += "uniform float u" + std::to_string(i) + ";\n";
+    fragment += "void main()\n{\n    float sum = 0.0;\n";
+    for (int i = 0; i < UNIFORM_COUNT; ++i)
+        fragment += "    sum += u" + std::to_string(i) + ";\n";
+    fragment += "    FragColor = vec4(sum);\n}\n";
+    std::string vertex = "#version 330 core\nvoid main()\n{\n    gl_Position = vec4(0.0);\n}\n";
+    Shader shader(writeBenchFile("uniform_bench.vs", vertex).c_str(),
+                  writeBenchFile("uniform_bench.fs", fragment).c_str());
+    shader.use();
+
+    std::vector<std::string> names;
+    std::vector<UniformHandle<float>> handles;
+    for (int i = 0; i < UNIFORM_COUNT; ++i)
+    {
+        names.push_back("u" + std::to_string(i));
+        handles.push_back(shader.getUniform<float>(names.back()));
+    }
+    std::printf("active uniforms: %d\n", (int)shader.activeUniforms().size());
+
+    // old path: a std::string per call (what setFloat("u3", ...) did) plus a driver name lookup
+    auto byLocation = [&](int frame) {
+        for (int i = 0; i < SETS_PER_FRAME; ++i)
+        {
+            std::string name = names[i % UNIFORM_COUNT];
+            glUniform1f(glGetUniformLocation(shader.ID, name.c_str()), (float)(frame + i));
+        }
+    };
+    // setFloat by name: hash + binary search in the table, no driver lookup
+    auto byName = [&](int frame) {
+        for (int i = 0; i < SETS_PER_FRAME; ++i)
+            shader.setFloat(names[i % UNIFORM_COUNT], (float)(frame + i));
+    };
+    // handles resolved once up front
+    auto byHandle = [&](int frame) {
+        for (int i = 0; i < SETS_PER_FRAME; ++i)
+            shader.set(handles[i % UNIFORM_COUNT], (float)(frame + i));
+    };
+    // the common case of a frame: most values are what they were last frame
+    auto unchanged = [&](int frame) {
+        for (int i = 0; i < SETS_PER_FRAME; ++i)
+            shader.set(handles[i % UNIFORM_COUNT], (float)(i % UNIFORM_COUNT + (i == 0 ? frame : 0)));
+    };
+
+    auto run = [&](const char* label, auto&& setUniforms) {
+        setUniforms(0); // warm up
+        shader.flush();
+        glFinish();
+        shader.resetUniformStats();
+        Stopwatch timer;
+        for (int frame = 0; frame < FRAMES; ++frame)
+        {
+            setUniforms(frame);
+            shader.flush();
+            glFinish();
+        }
+        double ms = timer.milliseconds() / FRAMES;
+        const UniformStats& stats = shader.uniformStats();
+        std::printf("%-28s %8.3f ms/frame  %7.1f ns/set  %6d redundant/frame  %4d uploads/frame\n", label, ms,
+                    ms * 1e6 / SETS_PER_FRAME, stats.redundant / FRAMES, stats.uploads / FRAMES);
+    };
+    run("glGetUniformLocation", byLocation);
+    shader.batchUploads = true;
+    run("setFloat(name) table", byName);
+    run("set(UniformHandle)", byHandle);
+    run("set(UniformHandle) unchanged", unchanged);
+    shader.batchUploads = false;
+    run("set(UniformHandle) immediate", byHandle);
+
+    glfwTerminate();
+    return 0;
+}
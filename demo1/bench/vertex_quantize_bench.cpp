@@ -0,0 +1,124 @@
+// vertex fetch bound draws: 1M points (position, color, texture coords) with the rasterizer
+// discarded, so the time is spent reading vertices, as 32 byte float vertices and as
+// the quantized encodings of vertex_quantize.h, with the error each encoding introduced
+#include "bench_util.h"
+
+#include <shader_s.h>
+#include <vertex_quantize.h>
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+const int GRID = 1024;
+const int DRAWS = 10;
+const int FRAMES = 50;
+
+const char* VERTEX_BODY =
+    "out vec3 ourColor;\n"
+    "out vec2 TexCoord;\n"
+    "void main()\n"
+    "{\n"
+    "    gl_Position = vec4(decodePosition() * 0.01, 1.0);\n"
+    "    ourColor = decodeColor();\n"
+    "    TexCoord = decodeTexCoord();\n"
+    "}\n";
+const char* FRAGMENT =
+    "#version 330 core\n"
+    "in vec3 ourColor;\n"
+    "in vec2 TexCoord;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    FragColor = vec4(ourColor * fract(TexCoord.x + TexCoord.y), 1.0);\n"
+    "}\n";
+
+// a GRID x GRID terrain of 100 x 100 units with gentle hills, a color gradient and
+// texture coords repeating 8 times
+static std::vector<float> makeVertices()
+{
+    std::vector<float> vertices;
+    vertices.reserve((size_t)GRID * GRID * 8);
+    for (int y = 0; y < GRID; ++y)
+        for (int x = 0; x < GRID; ++x)
+        {
+            float u = (float)x / (GRID - 1), v = (float)y / (GRID - 1);
+            float height = 4.0f * std::sin(u * 12.0f) * std::cos(v * 9.0f);
+            vertices.insert(vertices.end(), {u * 100.0f - 50.0f, height, v * 100.0f - 50.0f, u, v, 0.5f + height / 8.0f,
+                                             u * 8.0f, v * 8.0f});
+        }
+    return vertices;
+}
+
+static void runBench()
+{
+    const std::vector<float> vertices = makeVertices();
+    const size_t count = (size_t)GRID * GRID;
+
+    struct Variant
+    {
+        const char* label;
+        QuantizeOptions options;
+    };
+    std::vector<Variant> variants(4);
+    variants[0].label = "float (vec3, vec3, vec2)";
+    variants[0].options.position = PositionEncoding::Float;
+    variants[0].options.color = ColorEncoding::Float;
+    variants[0].options.texCoord = TexCoordEncoding::Float;
+    variants[1].label = "int16, float color and uv";
+    variants[1].options.color = ColorEncoding::Float;
+    variants[1].options.texCoord = TexCoordEncoding::Float;
+    variants[2].label = "half, rgba8, unorm16";
+    variants[2].options.position = PositionEncoding::Half;
+    variants[2].options.color = ColorEncoding::Unorm8;
+    variants[3].label = "int16, 2_10_10_10, unorm16";
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    for (const Variant& variant : variants)
+    {
+        Stopwatch timer;
+        QuantizedMesh mesh = quantizeVertices(vertices.data(), count, variant.options);
+        const double quantizeMs = timer.milliseconds();
+        Shader shader = Shader::fromSource("#version 330 core\n" + mesh.glsl() + VERTEX_BODY, FRAGMENT);
+        shader.use();
+        mesh.setDecodeUniforms(shader);
+
+        GLuint VAO, VBO;
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, mesh.data.size(), mesh.data.data(), GL_STATIC_DRAW);
+        mesh.setupAttributes();
+
+        glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+        glFinish();
+        timer.reset();
+        for (int frame = 0; frame < FRAMES; ++frame)
+        {
+            for (int draw = 0; draw < DRAWS; ++draw)
+                glDrawArrays(GL_POINTS, 0, (GLsizei)count);
+            glFinish();
+        }
+        const double ms = timer.milliseconds() / (FRAMES * DRAWS);
+        std::printf("%-28s %2zu bytes/vertex %8.3f ms/draw %7.2f GB/s (quantized in %.1f ms)\n", variant.label,
+                    mesh.stride, ms, mesh.data.size() / (ms * 1e6), quantizeMs);
+        std::printf("%-28s max error position %.3g (bound %.3g), color %.3g (bound %.3g), uv %.3g (bound %.3g)\n", "",
+                    mesh.measured.position, mesh.bound.position, mesh.measured.color, mesh.bound.color,
+                    mesh.measured.texCoord, mesh.bound.texCoord);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteProgram(shader.ID);
+    }
+    glDisable(GL_RASTERIZER_DISCARD);
+}
+
+int main()
+{
+    GLFWwindow* window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    runBench();
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,550 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <mip_chain.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Block compression on the CPU: BC1 (opaque, 4 bits per texel), BC3 (BC1 colour plus
+// an interpolated alpha block, 8 bits) and BC7 mode 6 (one RGBA endpoint pair with
+// 16 level indices, 8 bits). Every encoder works on one 4x4 block of RGBA bytes, the
+// image functions split the blocks over a ThreadPool. The decoders exist for drivers
+// without S3TC/BPTC and for measuring the error; the BC7 decoder only knows mode 6,
+// the only one the encoder writes.
+// ------------------------------------------------------------------------
+enum class BlockFormat : uint32_t
+{
+    None = 0, // uncompressed 8 bit channels
+    BC1 = 1,
+    BC3 = 3,
+    BC7 = 7
+};
+
+inline size_t blockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+inline size_t compressedSize(BlockFormat format, int width, int height)
+{
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+namespace bc_detail
+{
+typedef unsigned char Block[16][4]; // 4x4 RGBA texels, row by row
+
+inline int colorError(const unsigned char* a, const unsigned char* b, int channels)
+{
+    int error = 0;
+    for (int k = 0; k < channels; ++k)
+        error += (a[k] - b[k]) * (a[k] - b[k]);
+    return error;
+}
+
+// principal axis of the block's texels (first `channels` components) by power iteration
+inline void principalAxis(const Block& block, int channels, float mean[4], float axis[4])
+{
+    for (int k = 0; k < 4; ++k)
+        mean[k] = 0.0f;
+    for (int i = 0; i < 16; ++i)
+        for (int k = 0; k < channels; ++k)
+            mean[k] += block[i][k] / 16.0f;
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int r = 0; r < channels; ++r)
+            for (int c = 0; c < channels; ++c)
+                covariance[r][c] += (block[i][r] - mean[r]) * (block[i][c] - mean[c]);
+    for (int k = 0; k < 4; ++k)
+        axis[k] = k < channels ? 1.0f : 0.0f;
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[4] = {}, length = 0.0f;
+        for (int r = 0; r < channels; ++r)
+        {
+            for (int c = 0; c < channels; ++c)
+                next[r] += covariance[r][c] * axis[c];
+            length = std::max(length, std::fabs(next[r]));
+        }
+        if (length == 0.0f)
+            return; // flat block, any axis will do
+        for (int k = 0; k < channels; ++k)
+            axis[k] = next[k] / length;
+    }
+}
+
+// endpoints at the extreme projections of the texels on the principal axis
+inline void axisEndpoints(const Block& block, int channels, float inset, float low[4], float high[4])
+{
+    float mean[4], axis[4];
+    principalAxis(block, channels, mean, axis);
+    float minT = 1e30f, maxT = -1e30f, axisLength = 0.0f;
+    for (int k = 0; k < channels; ++k)
+        axisLength += axis[k] * axis[k];
+    if (axisLength == 0.0f)
+        axisLength = 1.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = 0.0f;
+        for (int k = 0; k < channels; ++k)
+            t += (block[i][k] - mean[k]) * axis[k];
+        t /= axisLength;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float shrink = (maxT - minT) * inset;
+    minT += shrink;
+    maxT -= shrink;
+    for (int k = 0; k < 4; ++k)
+    {
+        low[k] = k < channels ? std::min(255.0f, std::max(0.0f, mean[k] + axis[k] * minT)) : 255.0f;
+        high[k] = k < channels ? std::min(255.0f, std::max(0.0f, mean[k] + axis[k] * maxT)) : 255.0f;
+    }
+}
+
+// ------------------------------------------------------------------------
+// BC1 colour block
+inline uint16_t pack565(const float c[3])
+{
+    int r = (int)(c[0] * 31.0f / 255.0f + 0.5f), g = (int)(c[1] * 63.0f / 255.0f + 0.5f), b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpack565(uint16_t c, unsigned char out[4])
+{
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    out[0] = (unsigned char)((r << 3) | (r >> 2));
+    out[1] = (unsigned char)((g << 2) | (g >> 4));
+    out[2] = (unsigned char)((b << 3) | (b >> 2));
+    out[3] = 255;
+}
+
+inline void bc1Palette(uint16_t c0, uint16_t c1, unsigned char palette[4][4])
+{
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    for (int k = 0; k < 3; ++k)
+    {
+        if (c0 > c1)
+        {
+            palette[2][k] = (unsigned char)((2 * palette[0][k] + palette[1][k]) / 3);
+            palette[3][k] = (unsigned char)((palette[0][k] + 2 * palette[1][k]) / 3);
+        }
+        else
+        {
+            palette[2][k] = (unsigned char)((palette[0][k] + palette[1][k]) / 2);
+            palette[3][k] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = c0 > c1 ? 255 : 0;
+}
+
+// indices for fixed endpoints (always the 4 colour mode), returns the squared error
+inline int bc1Indices(const Block& block, uint16_t& c0, uint16_t& c1, uint32_t& indices)
+{
+    if (c0 < c1)
+        std::swap(c0, c1);
+    unsigned char palette[4][4];
+    bc1Palette(c0, c1, palette);
+    int total = 0;
+    indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestError = 1 << 30;
+        // equal endpoints select the 3 colour mode, where index 3 would be transparent
+        for (int p = 0; p < (c0 == c1 ? 1 : 4); ++p)
+        {
+            int error = colorError(block[i], palette[p], 3);
+            if (error < bestError)
+            {
+                best = p;
+                bestError = error;
+            }
+        }
+        indices |= (uint32_t)best << (2 * i);
+        total += bestError;
+    }
+    return total;
+}
+
+inline void encodeBC1Block(const Block& block, unsigned char out[8])
+{
+    float low[4], high[4];
+    axisEndpoints(block, 3, 1.0f / 16.0f, low, high);
+    uint16_t c0 = pack565(high), c1 = pack565(low);
+    uint32_t indices;
+    int error = bc1Indices(block, c0, c1, indices);
+
+    // one least squares refit of both endpoints to the chosen indices
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f}; // share of c0
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        float a = weights[(indices >> (2 * i)) & 3], b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int k = 0; k < 3; ++k)
+        {
+            ax[k] += a * block[i][k];
+            bx[k] += b * block[i][k];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (c0 != c1 && std::fabs(determinant) > 1e-6f)
+    {
+        float e0[3], e1[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            e0[k] = std::min(255.0f, std::max(0.0f, (ax[k] * bb - bx[k] * ab) / determinant));
+            e1[k] = std::min(255.0f, std::max(0.0f, (bx[k] * aa - ax[k] * ab) / determinant));
+        }
+        uint16_t r0 = pack565(e0), r1 = pack565(e1);
+        uint32_t refitIndices;
+        int refitError = bc1Indices(block, r0, r1, refitIndices);
+        if (refitError < error)
+        {
+            c0 = r0;
+            c1 = r1;
+            indices = refitIndices;
+        }
+    }
+    out[0] = (unsigned char)(c0 & 0xFF);
+    out[1] = (unsigned char)(c0 >> 8);
+    out[2] = (unsigned char)(c1 & 0xFF);
+    out[3] = (unsigned char)(c1 >> 8);
+    std::memcpy(out + 4, &indices, 4); // little endian, texel 0 in the low bits
+}
+
+inline void decodeBC1Block(const unsigned char in[8], Block& block)
+{
+    uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8)), c1 = (uint16_t)(in[2] | (in[3] << 8));
+    unsigned char palette[4][4];
+    bc1Palette(c0, c1, palette);
+    uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24);
+    for (int i = 0; i < 16; ++i)
+        std::memcpy(block[i], palette[(indices >> (2 * i)) & 3], 4);
+}
+
+// ------------------------------------------------------------------------
+// BC3: interpolated alpha block followed by a BC1 colour block
+inline void alphaPalette(int a0, int a1, int palette[8])
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+inline void encodeBC3Block(const Block& block, unsigned char out[16])
+{
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; ++i)
+    {
+        a0 = std::max(a0, (int)block[i][3]);
+        a1 = std::min(a1, (int)block[i][3]);
+    }
+    int palette[8];
+    alphaPalette(a0, a1, palette);
+    uint64_t indices = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0, bestError = 1 << 30;
+        for (int p = 0; p < (a0 == a1 ? 1 : 8); ++p)
+        {
+            int error = std::abs(block[i][3] - palette[p]);
+            if (error < bestError)
+            {
+                best = p;
+                bestError = error;
+            }
+        }
+        indices |= (uint64_t)best << (3 * i);
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 0; i < 6; ++i)
+        out[2 + i] = (unsigned char)(indices >> (8 * i));
+    encodeBC1Block(block, out + 8);
+}
+
+inline void decodeBC3Block(const unsigned char in[16], Block& block)
+{
+    decodeBC1Block(in + 8, block);
+    int palette[8];
+    alphaPalette(in[0], in[1], palette);
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= (uint64_t)in[2 + i] << (8 * i);
+    for (int i = 0; i < 16; ++i)
+        block[i][3] = (unsigned char)palette[(indices >> (3 * i)) & 7];
+}
+
+// ------------------------------------------------------------------------
+// BC7 mode 6: 7 bit RGBA endpoints plus one p-bit each, 4 bit indices
+static const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+inline int bc7Interpolate(int e0, int e1, int index)
+{
+    return ((64 - BC7_WEIGHTS4[index]) * e0 + BC7_WEIGHTS4[index] * e1 + 32) >> 6;
+}
+
+class BitWriter
+{
+public:
+    explicit BitWriter(unsigned char* out) : out(out) { std::memset(out, 0, 16); }
+    void write(uint32_t value, int bits)
+    {
+        for (int i = 0; i < bits; ++i, ++position)
+            out[position >> 3] |= (unsigned char)(((value >> i) & 1) << (position & 7));
+    }
+
+private:
+    unsigned char* out;
+    int position = 0;
+};
+
+class BitReader
+{
+public:
+    explicit BitReader(const unsigned char* in) : in(in) {}
+    uint32_t read(int bits)
+    {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i, ++position)
+            value |= (uint32_t)((in[position >> 3] >> (position & 7)) & 1) << i;
+        return value;
+    }
+
+private:
+    const unsigned char* in;
+    int position = 0;
+};
+
+inline void encodeBC7Block(const Block& block, unsigned char out[16])
+{
+    float low[4], high[4];
+    axisEndpoints(block, 4, 0.0f, low, high);
+
+    // try the four p-bit pairs, keep the one with the smallest error
+    int bestError = 1 << 30, bestQ[2][4] = {}, bestP[2] = {}, bestIndices[16] = {};
+    for (int pbits = 0; pbits < 4; ++pbits)
+    {
+        int p[2] = {pbits & 1, pbits >> 1}, q[2][4], e[2][4];
+        for (int k = 0; k < 4; ++k)
+        {
+            q[0][k] = std::min(127, std::max(0, (int)std::lround((low[k] - p[0]) / 2.0f)));
+            q[1][k] = std::min(127, std::max(0, (int)std::lround((high[k] - p[1]) / 2.0f)));
+            e[0][k] = (q[0][k] << 1) | p[0];
+            e[1][k] = (q[1][k] << 1) | p[1];
+        }
+        unsigned char palette[16][4];
+        for (int index = 0; index < 16; ++index)
+            for (int k = 0; k < 4; ++k)
+                palette[index][k] = (unsigned char)bc7Interpolate(e[0][k], e[1][k], index);
+        int total = 0, indices[16];
+        for (int i = 0; i < 16 && total < bestError; ++i)
+        {
+            int best = 0, bestTexel = 1 << 30;
+            for (int index = 0; index < 16; ++index)
+            {
+                int error = colorError(block[i], palette[index], 4);
+                if (error < bestTexel)
+                {
+                    best = index;
+                    bestTexel = error;
+                }
+            }
+            indices[i] = best;
+            total += bestTexel;
+        }
+        if (total < bestError)
+        {
+            bestError = total;
+            std::memcpy(bestQ, q, sizeof(q));
+            std::memcpy(bestP, p, sizeof(p));
+            std::memcpy(bestIndices, indices, sizeof(indices));
+        }
+    }
+    // the first index is stored with 3 bits: its top bit must be 0, swap the endpoints if not
+    if (bestIndices[0] & 8)
+    {
+        for (int k = 0; k < 4; ++k)
+            std::swap(bestQ[0][k], bestQ[1][k]);
+        std::swap(bestP[0], bestP[1]);
+        for (int i = 0; i < 16; ++i)
+            bestIndices[i] = 15 - bestIndices[i];
+    }
+    BitWriter bits(out);
+    bits.write(1 << 6, 7); // mode 6
+    for (int k = 0; k < 4; ++k)
+    {
+        bits.write(bestQ[0][k], 7);
+        bits.write(bestQ[1][k], 7);
+    }
+    bits.write(bestP[0], 1);
+    bits.write(bestP[1], 1);
+    bits.write(bestIndices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        bits.write(bestIndices[i], 4);
+}
+
+inline void decodeBC7Block(const unsigned char in[16], Block& block)
+{
+    BitReader bits(in);
+    if (bits.read(7) != (1 << 6))
+    {
+        // not mode 6: not produced by this encoder, show it as magenta
+        for (int i = 0; i < 16; ++i)
+        {
+            block[i][0] = 255;
+            block[i][1] = 0;
+            block[i][2] = 255;
+            block[i][3] = 255;
+        }
+        return;
+    }
+    int e[2][4];
+    for (int k = 0; k < 4; ++k)
+    {
+        e[0][k] = (int)bits.read(7) << 1;
+        e[1][k] = (int)bits.read(7) << 1;
+    }
+    int p0 = (int)bits.read(1), p1 = (int)bits.read(1);
+    for (int k = 0; k < 4; ++k)
+    {
+        e[0][k] |= p0;
+        e[1][k] |= p1;
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        int index = (int)bits.read(i == 0 ? 3 : 4);
+        for (int k = 0; k < 4; ++k)
+            block[i][k] = (unsigned char)bc7Interpolate(e[0][k], e[1][k], index);
+    }
+}
+
+// 4x4 block at (bx, by) of an image as RGBA, edges repeated for partial blocks
+inline void loadBlock(const MipImage& image, int bx, int by, Block& block)
+{
+    const int c = image.channels;
+    for (int y = 0; y < 4; ++y)
+        for (int x = 0; x < 4; ++x)
+        {
+            int sx = std::min(bx * 4 + x, image.width - 1), sy = std::min(by * 4 + y, image.height - 1);
+            const unsigned char* p = image.pixels.data() + ((size_t)sy * image.width + sx) * c;
+            unsigned char* t = block[y * 4 + x];
+            if (c <= 2) // grey, grey + alpha
+            {
+                t[0] = t[1] = t[2] = p[0];
+                t[3] = c == 2 ? p[1] : 255;
+            }
+            else
+            {
+                t[0] = p[0];
+                t[1] = p[1];
+                t[2] = p[2];
+                t[3] = c == 4 ? p[3] : 255;
+            }
+        }
+}
+} // namespace bc_detail
+
+// compress one image (level); blocks rows are spread over the pool when one is given
+// ------------------------------------------------------------------------
+inline std::vector<unsigned char> compressImage(const MipImage& image, BlockFormat format, ThreadPool* pool = nullptr)
+{
+    const int blocksX = (image.width + 3) / 4, blocksY = (image.height + 3) / 4;
+    const size_t bytes = blockBytes(format);
+    std::vector<unsigned char> out(compressedSize(format, image.width, image.height));
+    auto encodeRow = [&](size_t by) {
+        bc_detail::Block block;
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            bc_detail::loadBlock(image, bx, (int)by, block);
+            unsigned char* target = out.data() + (by * blocksX + bx) * bytes;
+            if (format == BlockFormat::BC1)
+                bc_detail::encodeBC1Block(block, target);
+            else if (format == BlockFormat::BC3)
+                bc_detail::encodeBC3Block(block, target);
+            else
+                bc_detail::encodeBC7Block(block, target);
+        }
+    };
+    if (pool && blocksY > 1)
+        pool->parallelFor((size_t)blocksY, encodeRow);
+    else
+        for (int by = 0; by < blocksY; ++by)
+            encodeRow((size_t)by);
+    return out;
+}
+
+// back to RGBA bytes, for GL implementations without the compressed format
+// ------------------------------------------------------------------------
+inline MipImage decompressImage(const unsigned char* data, int width, int height, BlockFormat format)
+{
+    MipImage image;
+    image.width = width;
+    image.height = height;
+    image.channels = 4;
+    image.pixels.resize((size_t)width * height * 4);
+    const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const size_t bytes = blockBytes(format);
+    bc_detail::Block block;
+    for (int by = 0; by < blocksY; ++by)
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            const unsigned char* source = data + ((size_t)by * blocksX + bx) * bytes;
+            if (format == BlockFormat::BC1)
+                bc_detail::decodeBC1Block(source, block);
+            else if (format == BlockFormat::BC3)
+                bc_detail::decodeBC3Block(source, block);
+            else
+                bc_detail::decodeBC7Block(source, block);
+            for (int y = 0; y < 4 && by * 4 + y < height; ++y)
+                for (int x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    std::memcpy(image.pixels.data() + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, block[y * 4 + x], 4);
+        }
+    return image;
+}
+
+// PSNR in dB of a decoded RGBA image against the source, over the source's channels
+// (grey is compared with the red channel); 99 for identical images
+// ------------------------------------------------------------------------
+inline double psnr(const MipImage& source, const MipImage& decoded)
+{
+    const int c = source.channels;
+    double squared = 0.0;
+    size_t samples = 0;
+    for (size_t i = 0; i < (size_t)source.width * source.height; ++i)
+    {
+        const unsigned char* s = source.pixels.data() + i * c;
+        const unsigned char* d = decoded.pixels.data() + i * decoded.channels;
+        for (int k = 0; k < c; ++k)
+        {
+            int dk = c <= 2 ? (k == 0 ? 0 : decoded.channels - 1) : k;
+            double difference = (double)s[k] - d[dk];
+            squared += difference * difference;
+            ++samples;
+        }
+    }
+    if (squared == 0.0)
+        return 99.0;
+    return 10.0 * std::log10(255.0 * 255.0 / (squared / samples));
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <block_compression.h>
+#include <mapped_file.h>
+#include <mip_chain.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cooked texture file (.ctex), written by tools/texcook and memory mapped at runtime:
+//
+//   CookedTextureHeader
+//   CookedTextureLevel[levelCount]   largest level first
+//   level data                       each level starts on a `alignment` byte boundary,
+//                                    rows tightly packed, 8 bit interleaved channels,
+//                                    or BC1/BC3/BC7 blocks when `format` says so
+//
+// Uploading is one glTexImage2D per level straight from the mapping, no decode and
+// no glGenerateMipmap. The file is native endian; it is a build product, not an
+// interchange format.
+// ------------------------------------------------------------------------
+struct CookedTextureHeader
+{
+    static constexpr uint32_t MAGIC = 0x58455443; // "CTEX"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t FLIPPED = 1;        // rows stored bottom up, as GL expects them
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t channels = 0;
+    uint32_t levelCount = 0;
+    uint32_t flags = 0;
+    uint32_t alignment = 64;
+    uint32_t format = 0;   // BlockFormat
+    uint32_t reserved = 0;
+};
+
+struct CookedTextureLevel
+{
+    uint64_t offset; // from the start of the file
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+class CookedTexture
+{
+public:
+    struct Level
+    {
+        const unsigned char* data;
+        size_t size;
+        int width;
+        int height;
+    };
+
+    CookedTexture() = default;
+    explicit CookedTexture(const std::string& path)
+    {
+        open(path);
+    }
+
+    // a file that is missing, truncated or of another version counts as not open
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path)
+    {
+        levels.clear();
+        if (!file.open(path) || file.size() < sizeof(CookedTextureHeader))
+        {
+            file.close();
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        size_t tableEnd = sizeof(header) + (size_t)header.levelCount * sizeof(CookedTextureLevel);
+        if (header.magic != CookedTextureHeader::MAGIC || header.version != CookedTextureHeader::VERSION ||
+            header.channels < 1 || header.channels > 4 || header.levelCount == 0 || tableEnd > file.size() ||
+            (header.format != 0 && header.format != 1 && header.format != 3 && header.format != 7))
+        {
+            std::cout << "ERROR::COOKED_TEXTURE::INVALID_FILE: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        for (uint32_t i = 0; i < header.levelCount; ++i)
+        {
+            CookedTextureLevel entry;
+            std::memcpy(&entry, file.data() + sizeof(header) + i * sizeof(CookedTextureLevel), sizeof(entry));
+            if (entry.offset > file.size() || entry.size > file.size() - entry.offset ||
+                entry.size != levelSize(entry.width, entry.height))
+            {
+                std::cout << "ERROR::COOKED_TEXTURE::INVALID_FILE: " << path << std::endl;
+                levels.clear();
+                file.close();
+                return false;
+            }
+            levels.push_back({(const unsigned char*)file.data() + entry.offset, (size_t)entry.size, (int)entry.width, (int)entry.height});
+        }
+        return true;
+    }
+    bool isOpen() const { return file.isOpen(); }
+    int width() const { return (int)header.width; }
+    int height() const { return (int)header.height; }
+    int channels() const { return (int)header.channels; }
+    bool flipped() const { return (header.flags & CookedTextureHeader::FLIPPED) != 0; }
+    BlockFormat format() const { return (BlockFormat)header.format; }
+    size_t levelCount() const { return levels.size(); }
+    const Level& level(size_t i) const { return levels[i]; }
+    size_t fileSize() const { return file.size(); }
+
+private:
+    MappedFile file;
+    CookedTextureHeader header;
+    std::vector<Level> levels;
+
+    uint64_t levelSize(uint32_t width, uint32_t height) const
+    {
+        if (format() != BlockFormat::None)
+            return compressedSize(format(), (int)width, (int)height);
+        return (uint64_t)width * height * header.channels;
+    }
+};
+
+// one level as it goes into the file: pixels or compressed blocks
+struct CookedLevelData
+{
+    int width;
+    int height;
+    const unsigned char* data;
+    size_t size;
+};
+
+// write the levels (largest first) as a .ctex file
+// ------------------------------------------------------------------------
+inline bool writeCookedTexture(const std::string& path, int channels, BlockFormat format, const std::vector<CookedLevelData>& levels,
+                               uint32_t flags, uint32_t alignment = 64)
+{
+    if (levels.empty() || alignment == 0 || alignment > 256)
+        return false;
+    CookedTextureHeader header;
+    header.width = (uint32_t)levels[0].width;
+    header.height = (uint32_t)levels[0].height;
+    header.channels = (uint32_t)channels;
+    header.levelCount = (uint32_t)levels.size();
+    header.flags = flags;
+    header.alignment = alignment;
+    header.format = (uint32_t)format;
+
+    std::vector<CookedTextureLevel> table;
+    uint64_t offset = sizeof(header) + levels.size() * sizeof(CookedTextureLevel);
+    for (const CookedLevelData& level : levels)
+    {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        table.push_back({offset, level.size, (uint32_t)level.width, (uint32_t)level.height});
+        offset += level.size;
+    }
+
+    // write to a temporary and rename, a failed cook never leaves a truncated file behind
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)table.data(), table.size() * sizeof(CookedTextureLevel));
+        uint64_t written = sizeof(header) + table.size() * sizeof(CookedTextureLevel);
+        const char padding[256] = {};
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            file.write(padding, (std::streamsize)(table[i].offset - written));
+            file.write((const char*)levels[i].data, levels[i].size);
+            written = table[i].offset + table[i].size;
+        }
+        if (!file)
+        {
+            std::cout << "ERROR::COOKED_TEXTURE::WRITE_FAILED: " << path << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+// uncompressed mip chain
+inline bool writeCookedTexture(const std::string& path, const std::vector<MipImage>& chain, uint32_t flags, uint32_t alignment = 64)
+{
+    std::vector<CookedLevelData> levels;
+    for (const MipImage& image : chain)
+        levels.push_back({image.width, image.height, image.pixels.data(), image.pixels.size()});
+    return !chain.empty() && writeCookedTexture(path, chain[0].channels, BlockFormat::None, levels, flags, alignment);
+}
+
+#endif
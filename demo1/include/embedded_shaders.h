@@ -0,0 +1,54 @@
+#ifndef EMBEDDED_SHADERS_H
+#define EMBEDDED_SHADERS_H
+
+#include <fnv1a.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+// A shader file compiled into the executable by the DEMO1_EMBED_SHADERS build step,
+// with its fnv1a64 computed at build time.
+struct EmbeddedShader
+{
+    const char* name;   // path relative to shader/, e.g. "4.2.texture.vs"
+    const char* data;   // null terminated, size excludes the terminator
+    size_t size;
+    uint64_t hash;
+
+    std::string_view view() const { return std::string_view(data, size); }
+};
+
+#ifdef DEMO1_EMBED_SHADERS
+#include <embedded_shaders_generated.h>
+
+// binary search in the name sorted table, nullptr when the file was not embedded
+// ------------------------------------------------------------------------
+inline const EmbeddedShader* findEmbeddedShader(std::string_view name)
+{
+    const EmbeddedShader* first = EMBEDDED_SHADERS;
+    size_t count = sizeof(EMBEDDED_SHADERS) / sizeof(EMBEDDED_SHADERS[0]);
+    while (count > 0)
+    {
+        size_t half = count / 2;
+        if (std::string_view(first[half].name) < name)
+        {
+            first += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+    if (first == EMBEDDED_SHADERS + sizeof(EMBEDDED_SHADERS) / sizeof(EMBEDDED_SHADERS[0]) || name != first->name)
+    {
+        std::cout << "ERROR::SHADER::NOT_EMBEDDED: " << name << std::endl;
+        return nullptr;
+    }
+    return first;
+}
+#endif
+
+#endif
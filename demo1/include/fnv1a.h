@@ -0,0 +1,49 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// FNV-1a hashing, usable at compile time so uniform names written as literals
+// ("texture1"_uh) cost nothing at runtime.
+// ------------------------------------------------------------------------
+constexpr uint32_t FNV1A32_OFFSET = 2166136261u;
+constexpr uint32_t FNV1A32_PRIME  = 16777619u;
+
+constexpr uint32_t fnv1a32(const char* str, size_t length, uint32_t hash = FNV1A32_OFFSET)
+{
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ static_cast<uint8_t>(str[i])) * FNV1A32_PRIME;
+    return hash;
+}
+
+inline uint32_t fnv1a32(const std::string& str)
+{
+    return fnv1a32(str.data(), str.size());
+}
+
+// 64 bit variant for content hashes (shader sources, cache keys)
+// ------------------------------------------------------------------------
+constexpr uint64_t FNV1A64_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV1A64_PRIME  = 1099511628211ull;
+
+constexpr uint64_t fnv1a64(const char* data, size_t length, uint64_t hash = FNV1A64_OFFSET)
+{
+    for (size_t i = 0; i < length; ++i)
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * FNV1A64_PRIME;
+    return hash;
+}
+
+inline uint64_t fnv1a64(const std::string& str, uint64_t hash = FNV1A64_OFFSET)
+{
+    return fnv1a64(str.data(), str.size(), hash);
+}
+
+// "name"_uh -> 32 bit hash of the uniform name
+constexpr uint32_t operator""_uh(const char* str, size_t length)
+{
+    return fnv1a32(str, length);
+}
+
+#endif
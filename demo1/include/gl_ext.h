@@ -0,0 +1,137 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <string>
+
+// Entry points and tokens newer than the 3.3 core profile glad is generated for.
+// Call glext::load() once after gladLoadGLLoader; every feature has a flag that
+// stays false when neither the core version nor the extension provides it.
+// ------------------------------------------------------------------------
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+
+namespace glext
+{
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+typedef void (APIENTRYP TexStorage2DProc)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP TexStorage3DProc)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+
+struct Functions
+{
+    int major = 0, minor = 0;
+
+    // GL 4.1 / ARB_get_program_binary
+    bool programBinary = false;
+    GetProgramBinaryProc GetProgramBinary = nullptr;
+    ProgramBinaryProc ProgramBinary = nullptr;
+    ProgramParameteriProc ProgramParameteri = nullptr;
+
+    // KHR_parallel_shader_compile / ARB_parallel_shader_compile
+    bool parallelShaderCompile = false;
+    MaxShaderCompilerThreadsProc MaxShaderCompilerThreads = nullptr;
+
+    // compressed texture formats, uploaded with the core glCompressedTexImage2D
+    bool textureCompressionS3tc = false; // EXT_texture_compression_s3tc: BC1, BC3
+    bool textureCompressionBptc = false; // GL 4.2 / ARB_texture_compression_bptc: BC7
+
+    // GL 4.2 / ARB_texture_storage: immutable, fully allocated textures
+    bool textureStorage = false;
+    TexStorage2DProc TexStorage2D = nullptr;
+    TexStorage3DProc TexStorage3D = nullptr;
+};
+
+inline Functions& functions()
+{
+    static Functions f;
+    return f;
+}
+
+inline bool versionAtLeast(int major, int minor)
+{
+    const Functions& f = functions();
+    return f.major > major || (f.major == major && f.minor >= minor);
+}
+
+inline bool hasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------------
+inline void load(GLADloadproc loader)
+{
+    Functions& f = functions();
+    glGetIntegerv(GL_MAJOR_VERSION, &f.major);
+    glGetIntegerv(GL_MINOR_VERSION, &f.minor);
+
+    if (versionAtLeast(4, 1) || hasExtension("GL_ARB_get_program_binary"))
+    {
+        f.GetProgramBinary = (GetProgramBinaryProc)loader("glGetProgramBinary");
+        f.ProgramBinary = (ProgramBinaryProc)loader("glProgramBinary");
+        f.ProgramParameteri = (ProgramParameteriProc)loader("glProgramParameteri");
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        f.programBinary = f.GetProgramBinary && f.ProgramBinary && f.ProgramParameteri && formats > 0;
+    }
+
+    // both extensions share GL_COMPLETION_STATUS; let the driver use as many threads as it likes
+    if (hasExtension("GL_KHR_parallel_shader_compile"))
+        f.MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsKHR");
+    else if (hasExtension("GL_ARB_parallel_shader_compile"))
+        f.MaxShaderCompilerThreads = (MaxShaderCompilerThreadsProc)loader("glMaxShaderCompilerThreadsARB");
+    f.parallelShaderCompile = f.MaxShaderCompilerThreads != nullptr;
+    if (f.parallelShaderCompile)
+        f.MaxShaderCompilerThreads(0xFFFFFFFFu);
+
+    f.textureCompressionS3tc = hasExtension("GL_EXT_texture_compression_s3tc");
+    f.textureCompressionBptc = versionAtLeast(4, 2) || hasExtension("GL_ARB_texture_compression_bptc");
+
+    if (versionAtLeast(4, 2) || hasExtension("GL_ARB_texture_storage"))
+    {
+        f.TexStorage2D = (TexStorage2DProc)loader("glTexStorage2D");
+        f.TexStorage3D = (TexStorage3DProc)loader("glTexStorage3D");
+        f.textureStorage = f.TexStorage2D && f.TexStorage3D;
+    }
+}
+} // namespace glext
+
+#endif
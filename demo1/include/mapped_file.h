@@ -0,0 +1,152 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file. The pages are handed out as is,
+// nothing is copied; an empty file maps to an empty, non-null view.
+// ------------------------------------------------------------------------
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path)
+    {
+        open(path);
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            bytes = other.bytes;
+            length = other.length;
+            opened = other.opened;
+#ifdef _WIN32
+            mapping = other.mapping;
+            other.mapping = NULL;
+#endif
+            other.bytes = nullptr;
+            other.length = 0;
+            other.opened = false;
+        }
+        return *this;
+    }
+
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+        {
+            CloseHandle(file);
+            return false;
+        }
+        length = (size_t)fileSize.QuadPart;
+        if (length > 0)
+        {
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping != NULL)
+                bytes = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (bytes == nullptr)
+            {
+                if (mapping != NULL)
+                    CloseHandle(mapping);
+                mapping = NULL;
+                CloseHandle(file);
+                length = 0;
+                return false;
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        if (length > 0)
+        {
+            void* address = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            posix_madvise(address, length, POSIX_MADV_SEQUENTIAL);
+            bytes = (const char*)address;
+        }
+        ::close(fd); // the mapping keeps the file alive
+#endif
+        opened = true;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        if (bytes != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(bytes);
+            CloseHandle(mapping);
+            mapping = NULL;
+#else
+            munmap((void*)bytes, length);
+#endif
+        }
+        bytes = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return bytes ? bytes : ""; }
+    size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(data(), length); }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE mapping = NULL;
+#endif
+};
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include <glad/glad.h>
+
+#include <mesh_optimize.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// One draw of a mesh: `count` indices of `indexType` at byte `offset` in the index
+// buffer, each added to `baseVertex` before the vertex fetch
+struct MeshDraw
+{
+    GLenum indexType;
+    GLsizei count;
+    size_t offset;
+    GLint baseVertex;
+};
+
+inline size_t indexSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_BYTE ? 1 : indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+// A VAO with its vertex and index buffer, drawn as one or more MeshDraws
+// ------------------------------------------------------------------------
+class Mesh
+{
+public:
+    Mesh() = default;
+    ~Mesh()
+    {
+        if (VAO)
+            glDeleteVertexArrays(1, &VAO);
+        if (VBO)
+            glDeleteBuffers(1, &VBO);
+        if (EBO)
+            glDeleteBuffers(1, &EBO);
+    }
+    Mesh(Mesh&& other) noexcept { *this = std::move(other); }
+    Mesh& operator=(Mesh&& other) noexcept
+    {
+        std::swap(VAO, other.VAO);
+        std::swap(VBO, other.VBO);
+        std::swap(EBO, other.EBO);
+        std::swap(draws, other.draws);
+        std::swap(primitive, other.primitive);
+        return *this;
+    }
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    void draw() const
+    {
+        glBindVertexArray(VAO);
+        for (const MeshDraw& part : draws)
+        {
+            if (part.baseVertex)
+                glDrawElementsBaseVertex(primitive, part.count, part.indexType, (const void*)part.offset, part.baseVertex);
+            else
+                glDrawElements(primitive, part.count, part.indexType, (const void*)part.offset);
+        }
+    }
+
+    bool isValid() const { return VAO != 0; }
+    GLuint vao() const { return VAO; }
+    const std::vector<MeshDraw>& parts() const { return draws; }
+    // the index type of the first draw, for code that draws the VAO itself
+    GLenum indexType() const { return draws.empty() ? GL_UNSIGNED_INT : draws[0].indexType; }
+
+private:
+    friend class MeshBuilder;
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    std::vector<MeshDraw> draws;
+    GLenum primitive = GL_TRIANGLES;
+};
+
+// Collects interleaved vertices and 32 bit indices and uploads them with the smallest
+// index type that fits: GL_UNSIGNED_BYTE up to 256 vertices, GL_UNSIGNED_SHORT up to
+// 65536. Larger meshes are split into runs of primitives whose vertices lie within
+// 65536 of each other, each stored relative to its lowest vertex and drawn with
+// glDrawElementsBaseVertex, so one VAO still serves every draw. A primitive spanning
+// more than that goes into a 32 bit draw. If the index order is too scattered for
+// that to give a few large draws, the whole mesh stays one 32 bit draw instead.
+// The builder keeps totals over every mesh it built; report() prints the index
+// memory saved against uploading everything as GL_UNSIGNED_INT.
+// ------------------------------------------------------------------------
+class MeshBuilder
+{
+public:
+    GLenum primitive = GL_TRIANGLES; // GL_TRIANGLES, GL_LINES or GL_POINTS
+    bool allowByteIndices = true;    // some hardware converts 8 bit indices on the CPU
+    GLenum usage = GL_STATIC_DRAW;
+
+    struct Stats
+    {
+        size_t meshes = 0;
+        size_t draws = 0;
+        size_t indices = 0;
+        size_t indexBytes = 0;   // uploaded
+        size_t uint32Bytes = 0;  // the same indices as GL_UNSIGNED_INT
+        size_t byteDraws = 0, shortDraws = 0, intDraws = 0;
+        VertexCacheStats beforeOptimize, afterOptimize; // over every optimize()
+    };
+
+    MeshBuilder& setVertices(const void* data, size_t count, size_t stride)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        vertexData.assign(bytes, bytes + count * stride);
+        vertexCount = count;
+        vertexStride = stride;
+        return *this;
+    }
+    template <typename Vertex>
+    MeshBuilder& setVertices(const Vertex* vertices, size_t count)
+    {
+        return setVertices((const void*)vertices, count, sizeof(Vertex));
+    }
+    MeshBuilder& setIndices(const uint32_t* data, size_t count)
+    {
+        indexData.assign(data, data + count);
+        return *this;
+    }
+
+    // mesh_optimize.h's passes on the current triangles: vertex cache order, then overdraw
+    // order (`positionOffset`: bytes to a float x, y, z in each vertex, negative to skip
+    // it), then vertex fetch order. Vertices no triangle uses are dropped
+    // ------------------------------------------------------------------------
+    MeshBuilder& optimize(int positionOffset = 0, float overdrawThreshold = 1.05f)
+    {
+        uint32_t highest;
+        if (primitive != GL_TRIANGLES || !checkIndices(3, highest))
+            return *this;
+        const VertexCacheStats before = analyzeVertexCache(indexData.data(), indexData.size(), vertexCount);
+        optimizeVertexCache(indexData.data(), indexData.size(), vertexCount);
+        if (positionOffset >= 0)
+            optimizeOverdraw(indexData.data(), indexData.size(), vertexData.data() + positionOffset, vertexCount,
+                             vertexStride, overdrawThreshold);
+        vertexCount = optimizeVertexFetch(vertexData.data(), vertexCount, vertexStride, indexData.data(), indexData.size());
+        vertexData.resize(vertexCount * vertexStride);
+        const VertexCacheStats after = analyzeVertexCache(indexData.data(), indexData.size(), vertexCount);
+        for (VertexCacheStats* total : {&stats.beforeOptimize, &stats.afterOptimize})
+        {
+            const VertexCacheStats& add = total == &stats.beforeOptimize ? before : after;
+            total->triangles += add.triangles;
+            total->vertices += add.vertices;
+            total->misses += add.misses;
+        }
+        return *this;
+    }
+
+    // upload into a new VAO; `setupAttributes` describes the vertex layout for the bound
+    // VAO and GL_ARRAY_BUFFER, e.g. [] { TexturedVertex::setupAttributes(); }
+    // ------------------------------------------------------------------------
+    Mesh build(const std::function<void()>& setupAttributes)
+    {
+        Mesh mesh;
+        const size_t perPrimitive = primitive == GL_TRIANGLES ? 3 : primitive == GL_LINES ? 2 : 1;
+        uint32_t highest;
+        if (!checkIndices(perPrimitive, highest))
+            return mesh;
+
+        std::vector<unsigned char> packed;
+        mesh.draws = splitDraws(perPrimitive, highest, packed);
+        mesh.primitive = primitive;
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        glGenBuffers(1, &mesh.EBO);
+        glBindVertexArray(mesh.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), usage);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, packed.size(), packed.data(), usage);
+        setupAttributes();
+        glBindVertexArray(0);
+
+        ++stats.meshes;
+        stats.draws += mesh.draws.size();
+        stats.indices += indexData.size();
+        stats.indexBytes += packed.size();
+        stats.uint32Bytes += indexData.size() * sizeof(uint32_t);
+        for (const MeshDraw& part : mesh.draws)
+        {
+            size_t& draws = part.indexType == GL_UNSIGNED_BYTE ? stats.byteDraws
+                          : part.indexType == GL_UNSIGNED_SHORT ? stats.shortDraws : stats.intDraws;
+            ++draws;
+        }
+        return mesh;
+    }
+
+    size_t vertices() const { return vertexCount; }
+    size_t stride() const { return vertexStride; }
+    const std::vector<uint32_t>& indices() const { return indexData; }
+    const Stats& statistics() const { return stats; }
+
+    void report() const
+    {
+        const size_t saved = stats.uint32Bytes - stats.indexBytes;
+        std::cout << "MESH::BUILD: " << stats.meshes << " meshes, " << stats.indices << " indices in " << stats.draws
+                  << " draws (" << stats.byteDraws << " 8 bit, " << stats.shortDraws << " 16 bit, " << stats.intDraws
+                  << " 32 bit), index memory " << stats.indexBytes << " bytes instead of " << stats.uint32Bytes
+                  << ", " << saved << " bytes (" << (stats.uint32Bytes ? saved * 100 / stats.uint32Bytes : 0)
+                  << "%) saved" << std::endl;
+        if (stats.beforeOptimize.triangles)
+            std::cout << "MESH::OPTIMIZE: " << stats.beforeOptimize.triangles << " triangles, ACMR "
+                      << stats.beforeOptimize.acmr() << " -> " << stats.afterOptimize.acmr() << ", ATVR "
+                      << stats.beforeOptimize.atvr() << " -> " << stats.afterOptimize.atvr() << std::endl;
+    }
+
+private:
+    std::vector<unsigned char> vertexData;
+    size_t vertexCount = 0;
+    size_t vertexStride = 0;
+    std::vector<uint32_t> indexData;
+    Stats stats;
+
+    // whole primitives and every index within the vertices; `highest` is the largest index
+    bool checkIndices(size_t perPrimitive, uint32_t& highest) const
+    {
+        highest = 0;
+        if (indexData.empty() || indexData.size() % perPrimitive != 0)
+        {
+            std::cout << "ERROR::MESH::INDEX_COUNT: " << indexData.size() << " indices for primitives of "
+                      << perPrimitive << std::endl;
+            return false;
+        }
+        for (uint32_t index : indexData)
+        {
+            if (index >= vertexCount)
+            {
+                std::cout << "ERROR::MESH::INDEX_OUT_OF_RANGE: " << index << " >= " << vertexCount << std::endl;
+                return false;
+            }
+            highest = std::max(highest, index);
+        }
+        return true;
+    }
+
+    struct Run
+    {
+        size_t first, count; // in indices
+        uint32_t low, high;
+        bool wide;           // primitives spanning more than 16 bits
+    };
+
+    GLenum typeFor(uint32_t span) const
+    {
+        return allowByteIndices && span <= 0xff ? GL_UNSIGNED_BYTE : span <= 0xffff ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    }
+
+    // consecutive primitives whose vertices stay within a 16 bit window (or, for wide
+    // primitives, runs of those), packed into `packed` with each draw's offset aligned
+    // to its index size
+    // ------------------------------------------------------------------------
+    std::vector<MeshDraw> splitDraws(size_t perPrimitive, uint32_t highest, std::vector<unsigned char>& packed) const
+    {
+        std::vector<Run> runs;
+        if (highest <= 0xffff)
+            runs.push_back({0, indexData.size(), 0, highest, false});
+        else
+        {
+            for (size_t first = 0; first < indexData.size(); first += perPrimitive)
+            {
+                uint32_t low = indexData[first], high = low;
+                for (size_t i = 1; i < perPrimitive; ++i)
+                {
+                    low = std::min(low, indexData[first + i]);
+                    high = std::max(high, indexData[first + i]);
+                }
+                const bool wide = high - low > 0xffff;
+                if (!runs.empty() && runs.back().wide == wide)
+                {
+                    Run& run = runs.back();
+                    const uint32_t runLow = std::min(run.low, low), runHigh = std::max(run.high, high);
+                    if (wide || runHigh - runLow <= 0xffff)
+                    {
+                        run.low = runLow;
+                        run.high = runHigh;
+                        run.count += perPrimitive;
+                        continue;
+                    }
+                }
+                runs.push_back({first, perPrimitive, low, high, wide});
+            }
+            // scattered index order: more than a few draws per 64k vertices costs more in
+            // draw calls than the smaller indices save
+            const size_t expected = vertexCount / 0x10000 + 1;
+            if (runs.size() > expected * 4)
+                runs.assign(1, Run{0, indexData.size(), 0, highest, true});
+        }
+
+        std::vector<MeshDraw> draws;
+        for (const Run& run : runs)
+        {
+            const uint32_t base = run.wide ? 0 : run.low;
+            const GLenum type = run.wide ? GL_UNSIGNED_INT : typeFor(run.high - base);
+            const size_t size = indexSize(type);
+            packed.resize((packed.size() + size - 1) / size * size);
+            const size_t offset = packed.size();
+            packed.resize(offset + run.count * size);
+            for (size_t i = 0; i < run.count; ++i)
+            {
+                const uint32_t index = indexData[run.first + i] - base;
+                if (type == GL_UNSIGNED_BYTE)
+                    packed[offset + i] = (unsigned char)index;
+                else if (type == GL_UNSIGNED_SHORT)
+                {
+                    const uint16_t value = (uint16_t)index;
+                    std::memcpy(&packed[offset + i * 2], &value, 2);
+                }
+                else
+                    std::memcpy(&packed[offset + i * 4], &index, 4);
+            }
+            draws.push_back({type, (GLsizei)run.count, offset, (GLint)base});
+        }
+        return draws;
+    }
+};
+
+#endif
@@ -0,0 +1,907 @@
+#ifndef MESH_LOADER_H
+#define MESH_LOADER_H
+
+#include <mapped_file.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Mesh import for Wavefront OBJ and binary glTF (.glb). The file is mapped (mapped_file.h)
+// and parsed in place, no iostreams. OBJ files are cut into chunks at line ends that
+// worker threads parse at the same time with their own float parser; the corners of
+// the faces are then scattered by key hash into one bucket per thread and welded into
+// unique vertices with a hash table per bucket, numbered in order of first use. GLB
+// primitives are already indexed and are converted in parallel.
+// The result is the interleaved vertex main.cpp draws (position, color, texture
+// coords; TexturedVertex) with 32 bit indices, ready for MeshBuilder. OBJ colors come
+// from the "v x y z r g b" extension, white otherwise; normals are not part of that
+// layout and are skipped. glTF texture coords are flipped to GL's bottom-up origin,
+// like the textures, and node transforms are not applied.
+// ------------------------------------------------------------------------
+struct LoadedMesh
+{
+    static constexpr size_t FLOATS_PER_VERTEX = 8;
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    bool valid = false;
+    std::string path;
+    size_t fileBytes = 0;
+    size_t corners = 0; // face corners before welding (OBJ)
+    double mapMs = 0.0, parseMs = 0.0, weldMs = 0.0, totalMs = 0.0;
+
+    size_t vertexCount() const { return vertices.size() / FLOATS_PER_VERTEX; }
+    size_t triangleCount() const { return indices.size() / 3; }
+
+    void report() const
+    {
+        std::cout << "MESH::LOAD: " << path << ": " << fileBytes / (1 << 20) << " MiB in " << totalMs << " ms ("
+                  << (totalMs > 0.0 ? fileBytes / (totalMs * 1e3) : 0.0) << " MB/s; map " << mapMs << " ms, parse "
+                  << parseMs << " ms, weld " << weldMs << " ms), " << vertexCount() << " vertices";
+        if (corners)
+            std::cout << " welded from " << corners << " corners";
+        std::cout << ", " << triangleCount() << " triangles" << std::endl;
+    }
+};
+
+namespace mesh_parse
+{
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+// job(i) for i < count on the pool and the calling thread, or in order without a pool
+inline void forEach(ThreadPool* pool, size_t count, const std::function<void(size_t)>& job)
+{
+    if (pool && count > 1)
+        pool->parallelFor(count, job);
+    else
+        for (size_t i = 0; i < count; ++i)
+            job(i);
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline const char* skipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+inline const char* skipLine(const char* p, const char* end)
+{
+    const char* newline = (const char*)std::memchr(p, '\n', end - p);
+    return newline ? newline + 1 : end;
+}
+
+// decimal float with optional sign, fraction and exponent; the first 19 significant
+// digits scaled by an exact power of ten where possible, which is within an ulp of
+// strtof for anything a mesh exporter writes. Returns null when there is no number
+// ------------------------------------------------------------------------
+inline const char* parseFloat(const char* p, const char* end, float& value)
+{
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p, any = true)
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+            ++exponent;
+    }
+    if (p < end && *p == '.')
+        for (++p; p < end && isDigit(*p); ++p, any = true)
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+    if (!any)
+    {
+        // nan, inf and the like through the C library, on a terminated copy
+        char text[32];
+        const size_t length = std::min<size_t>(end - start, sizeof(text) - 1);
+        std::memcpy(text, start, length);
+        text[length] = '\0';
+        char* stop = nullptr;
+        value = std::strtof(text, &stop);
+        return stop == text ? nullptr : start + (stop - text);
+    }
+    if (p + 1 < end && (*p == 'e' || *p == 'E') &&
+        (isDigit(p[1]) || ((p[1] == '-' || p[1] == '+') && p + 2 < end && isDigit(p[2]))))
+    {
+        ++p;
+        const bool negativeExponent = *p == '-';
+        if (*p == '-' || *p == '+')
+            ++p;
+        int e = 0;
+        for (; p < end && isDigit(*p); ++p)
+            e = std::min(e * 10 + (*p - '0'), 10000);
+        exponent += negativeExponent ? -e : e;
+    }
+    double result = (double)mantissa;
+    if (mantissa != 0 && exponent != 0)
+    {
+        if (exponent < 0 && exponent >= -22)
+            result /= powers[-exponent];
+        else if (exponent > 0 && exponent <= 22)
+            result *= powers[exponent];
+        else
+            result *= std::pow(10.0, (double)exponent);
+    }
+    value = (float)(negative ? -result : result);
+    return p;
+}
+inline const char* parseInt(const char* p, const char* end, int64_t& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if (p >= end || !isDigit(*p))
+        return nullptr;
+    int64_t result = 0;
+    for (; p < end && isDigit(*p); ++p)
+        result = std::min<int64_t>(result * 10 + (*p - '0'), INT64_C(1) << 40);
+    value = negative ? -result : result;
+    return p;
+}
+
+// ------------------------------------------------------------------------
+// OBJ
+// ------------------------------------------------------------------------
+struct ObjCorner
+{
+    int64_t position;
+    int64_t texCoord;  // -1: none
+    uint8_t relative;  // 1: position, 2: texCoord counted back from the chunk's count at that line
+};
+
+struct ObjChunk
+{
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<float> positions; // x, y, z
+    std::vector<float> colors;    // r, g, b per position once a colored one was seen
+    std::vector<float> texCoords; // u, v
+    std::vector<ObjCorner> corners; // three per triangle
+    std::string error;
+};
+
+inline void parseObjChunk(ObjChunk& chunk)
+{
+    const char* p = chunk.begin;
+    const char* end = chunk.end;
+    std::vector<ObjCorner> polygon;
+    auto fail = [&](const char* line) {
+        if (chunk.error.empty())
+            chunk.error = std::string(line, std::find(line, end, '\n'));
+    };
+    while (p < end)
+    {
+        p = skipSpaces(p, end);
+        const char* line = p;
+        if (p + 1 < end && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            float xyz[6];
+            p += 2;
+            int count = 0;
+            for (; count < 6; ++count)
+            {
+                const char* next = parseFloat(skipSpaces(p, end), end, xyz[count]);
+                if (!next)
+                    break;
+                p = next;
+            }
+            if (count < 3)
+                fail(line);
+            else
+            {
+                chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+                if (count == 6 && chunk.colors.empty())
+                    chunk.colors.resize(chunk.positions.size() - 3, 1.0f);
+                if (count == 6 || !chunk.colors.empty())
+                {
+                    const float white[3] = {1.0f, 1.0f, 1.0f};
+                    chunk.colors.insert(chunk.colors.end(), count == 6 ? xyz + 3 : white, count == 6 ? xyz + 6 : white + 3);
+                }
+            }
+        }
+        else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+        {
+            float uv[2] = {0.0f, 0.0f};
+            p += 3;
+            const char* next = parseFloat(skipSpaces(p, end), end, uv[0]);
+            if (next)
+            {
+                p = next;
+                next = parseFloat(skipSpaces(p, end), end, uv[1]); // v is optional
+                if (next)
+                    p = next;
+                chunk.texCoords.insert(chunk.texCoords.end(), uv, uv + 2);
+            }
+            else
+                fail(line);
+        }
+        else if (p + 1 < end && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            polygon.clear();
+            p = skipSpaces(p + 2, end);
+            while (p < end && *p != '\n' && *p != '#')
+            {
+                int64_t index[2] = {0, 0};
+                const char* next = parseInt(p, end, index[0]);
+                if (!next || index[0] == 0)
+                    break;
+                p = next;
+                if (p < end && *p == '/')
+                {
+                    next = parseInt(++p, end, index[1]);
+                    if (next)
+                        p = next;
+                    while (p < end && (*p == '/' || isDigit(*p) || *p == '-')) // the normal
+                        ++p;
+                }
+                ObjCorner corner;
+                corner.relative = 0;
+                const int64_t counts[2] = {(int64_t)chunk.positions.size() / 3, (int64_t)chunk.texCoords.size() / 2};
+                for (int i = 0; i < 2; ++i)
+                {
+                    int64_t resolved = -1;
+                    if (index[i] > 0)
+                        resolved = index[i] - 1;
+                    else if (index[i] < 0)
+                    {
+                        resolved = counts[i] + index[i];
+                        corner.relative |= (uint8_t)(1 << i);
+                    }
+                    (i == 0 ? corner.position : corner.texCoord) = resolved;
+                }
+                polygon.push_back(corner);
+                p = skipSpaces(p, end);
+            }
+            if (polygon.size() < 3 || (p < end && *p != '\n' && *p != '#'))
+                fail(line);
+            else
+                for (size_t i = 2; i < polygon.size(); ++i)
+                    chunk.corners.insert(chunk.corners.end(), {polygon[0], polygon[i - 1], polygon[i]});
+        }
+        p = skipLine(p, end);
+    }
+}
+
+// open addressing from (position, texture coord) to the first corner using it; key and
+// corner share a slot so a probe touches one cache line
+class WeldTable
+{
+public:
+    explicit WeldTable(size_t expected)
+    {
+        size_t capacity = 1024;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        slots.assign(capacity, Slot{EMPTY, 0});
+    }
+    static uint64_t hash(uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        return key;
+    }
+    // the first corner of `key`, `corner` when it is new
+    uint32_t insert(uint64_t key, uint64_t hashed, uint32_t corner)
+    {
+        if ((count + 1) * 2 > slots.size())
+            grow();
+        const size_t mask = slots.size() - 1;
+        for (size_t slot = hashed & mask;; slot = (slot + 1) & mask)
+        {
+            if (slots[slot].key == key)
+                return slots[slot].first;
+            if (slots[slot].key == EMPTY)
+            {
+                slots[slot] = Slot{key, corner};
+                ++count;
+                return corner;
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY = ~0ull;
+    struct Slot
+    {
+        uint64_t key;
+        uint32_t first;
+    };
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    void grow()
+    {
+        std::vector<Slot> old(slots.size() * 2, Slot{EMPTY, 0});
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        for (const Slot& entry : old)
+        {
+            if (entry.key == EMPTY)
+                continue;
+            size_t slot = hash(entry.key) & mask;
+            while (slots[slot].key != EMPTY)
+                slot = (slot + 1) & mask;
+            slots[slot] = entry;
+        }
+    }
+};
+
+// ------------------------------------------------------------------------
+inline bool loadObj(const char* data, size_t size, ThreadPool* pool, LoadedMesh& mesh)
+{
+    auto start = std::chrono::steady_clock::now();
+    const size_t threads = pool ? pool->size() + 1 : 1;
+    // chunks of at least 1 MiB, a few per thread so uneven ones even out
+    const size_t chunkCount = std::max<size_t>(1, std::min(size >> 20, threads * 4));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* cursor = data;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        chunks[i].begin = cursor;
+        cursor = i + 1 == chunkCount ? data + size : skipLine(std::max(cursor, data + size / chunkCount * (i + 1)), data + size);
+        chunks[i].end = cursor;
+    }
+    forEach(pool, chunkCount, [&](size_t i) { parseObjChunk(chunks[i]); });
+    for (const ObjChunk& chunk : chunks)
+        if (!chunk.error.empty())
+        {
+            std::cout << "ERROR::MESH_LOADER::OBJ_BAD_LINE: " << chunk.error << std::endl;
+            return false;
+        }
+
+    // every chunk's attributes and corners behind those of the chunks before it
+    std::vector<size_t> positionStart(chunkCount + 1, 0), texCoordStart(chunkCount + 1, 0), cornerStart(chunkCount + 1, 0);
+    bool colored = false;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        positionStart[i + 1] = positionStart[i] + chunks[i].positions.size() / 3;
+        texCoordStart[i + 1] = texCoordStart[i] + chunks[i].texCoords.size() / 2;
+        cornerStart[i + 1] = cornerStart[i] + chunks[i].corners.size();
+        colored = colored || !chunks[i].colors.empty();
+    }
+    const size_t positionCount = positionStart[chunkCount], texCoordCount = texCoordStart[chunkCount];
+    const size_t cornerCount = cornerStart[chunkCount];
+    if (cornerCount == 0 || cornerCount > 0xffffffffu || positionCount >= 0xffffffffu || texCoordCount >= 0xffffffffu)
+    {
+        std::cout << "ERROR::MESH_LOADER::OBJ_SIZE: " << cornerCount << " corners, " << positionCount << " positions"
+                  << std::endl;
+        return false;
+    }
+    std::vector<float> positions(positionCount * 3), colors(colored ? positionCount * 3 : 0), texCoords(texCoordCount * 2);
+    std::vector<uint64_t> keys(cornerCount); // position << 32 | texCoord + 1
+    // the weld splits the keys between the threads by hash; corners per chunk and thread
+    auto partitionOf = [threads](uint64_t key) {
+        return threads == 1 ? 0 : (size_t)((WeldTable::hash(key) >> 40) % threads);
+    };
+    std::vector<size_t> partitionCounts(chunkCount * threads, 0);
+    std::atomic<bool> outOfRange(false);
+    forEach(pool, chunkCount, [&](size_t i) {
+        ObjChunk& chunk = chunks[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionStart[i] * 3);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + texCoordStart[i] * 2);
+        if (colored)
+        {
+            if (chunk.colors.empty())
+                std::fill_n(colors.begin() + positionStart[i] * 3, chunk.positions.size(), 1.0f);
+            else
+                std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin() + positionStart[i] * 3);
+        }
+        for (size_t c = 0; c < chunk.corners.size(); ++c)
+        {
+            const ObjCorner& corner = chunk.corners[c];
+            const int64_t position = corner.position + (corner.relative & 1 ? (int64_t)positionStart[i] : 0);
+            const int64_t texCoord = corner.texCoord < 0 && !(corner.relative & 2)
+                                         ? -1
+                                         : corner.texCoord + (corner.relative & 2 ? (int64_t)texCoordStart[i] : 0);
+            if (position < 0 || position >= (int64_t)positionCount || texCoord < -1 || texCoord >= (int64_t)texCoordCount)
+                outOfRange = true;
+            const uint64_t key = (uint64_t)position << 32 | (uint64_t)(texCoord + 1);
+            keys[cornerStart[i] + c] = key;
+            ++partitionCounts[i * threads + partitionOf(key)];
+        }
+        std::vector<ObjCorner>().swap(chunk.corners);
+    });
+    if (outOfRange)
+    {
+        std::cout << "ERROR::MESH_LOADER::OBJ_INDEX_OUT_OF_RANGE: " << mesh.path << std::endl;
+        return false;
+    }
+    mesh.parseMs = millisecondsSince(start);
+
+    // weld: the corners are scattered once into one bucket per thread by key hash, each
+    // bucket in file order; thread q then finds the first corner with the same key for
+    // every corner in bucket q. First corners become the vertices, in file order
+    start = std::chrono::steady_clock::now();
+    std::vector<size_t> bucketStart(threads + 1, cornerCount), scatterAt(chunkCount * threads);
+    for (size_t q = 0, at = 0; q < threads; ++q)
+    {
+        bucketStart[q] = at;
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            scatterAt[i * threads + q] = at;
+            at += partitionCounts[i * threads + q];
+        }
+    }
+    std::vector<uint32_t> bucket(cornerCount);
+    forEach(pool, chunkCount, [&](size_t i) {
+        size_t* at = &scatterAt[i * threads];
+        for (size_t c = cornerStart[i]; c < cornerStart[i + 1]; ++c)
+            bucket[at[partitionOf(keys[c])]++] = (uint32_t)c;
+    });
+    std::vector<uint32_t> firstCorner(cornerCount);
+    forEach(pool, threads, [&](size_t q) {
+        // about one vertex per position in most files; the table grows when there are more
+        WeldTable table(std::max(positionCount, texCoordCount) / threads);
+        for (size_t k = bucketStart[q]; k < bucketStart[q + 1]; ++k)
+        {
+            const uint32_t c = bucket[k];
+            firstCorner[c] = table.insert(keys[c], WeldTable::hash(keys[c]), c);
+        }
+    });
+    std::vector<uint32_t>().swap(bucket);
+    const size_t ranges = std::max<size_t>(1, std::min(cornerCount / 65536, threads * 4));
+    std::vector<size_t> vertexStart(ranges + 1, 0);
+    std::vector<uint32_t> vertexOf(cornerCount); // valid for first corners
+    auto range = [&](size_t r) { return std::make_pair(cornerCount * r / ranges, cornerCount * (r + 1) / ranges); };
+    forEach(pool, ranges, [&](size_t r) {
+        size_t count = 0;
+        for (size_t c = range(r).first; c < range(r).second; ++c)
+            count += firstCorner[c] == c;
+        vertexStart[r + 1] = count;
+    });
+    for (size_t r = 0; r < ranges; ++r)
+        vertexStart[r + 1] += vertexStart[r];
+    mesh.vertices.resize(vertexStart[ranges] * LoadedMesh::FLOATS_PER_VERTEX);
+    mesh.indices.resize(cornerCount);
+    forEach(pool, ranges, [&](size_t r) {
+        uint32_t next = (uint32_t)vertexStart[r];
+        for (size_t c = range(r).first; c < range(r).second; ++c)
+        {
+            if (firstCorner[c] != c)
+                continue;
+            const size_t position = keys[c] >> 32, texCoord = keys[c] & 0xffffffffu;
+            float* vertex = &mesh.vertices[(size_t)next * LoadedMesh::FLOATS_PER_VERTEX];
+            std::memcpy(vertex, &positions[position * 3], 3 * sizeof(float));
+            if (colored)
+                std::memcpy(vertex + 3, &colors[position * 3], 3 * sizeof(float));
+            else
+                vertex[3] = vertex[4] = vertex[5] = 1.0f;
+            vertex[6] = texCoord ? texCoords[(texCoord - 1) * 2] : 0.0f;
+            vertex[7] = texCoord ? texCoords[(texCoord - 1) * 2 + 1] : 0.0f;
+            vertexOf[c] = next++;
+        }
+    });
+    forEach(pool, ranges, [&](size_t r) {
+        for (size_t c = range(r).first; c < range(r).second; ++c)
+            mesh.indices[c] = vertexOf[firstCorner[c]];
+    });
+    mesh.corners = cornerCount;
+    mesh.weldMs = millisecondsSince(start);
+    return true;
+}
+
+// ------------------------------------------------------------------------
+// GLB: the JSON chunk as a small DOM, accessors read from the BIN chunk
+// ------------------------------------------------------------------------
+struct JsonValue
+{
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* get(const char* key) const
+    {
+        for (const auto& member : object)
+            if (member.first == key)
+                return &member.second;
+        return nullptr;
+    }
+    const JsonValue* at(size_t index) const { return index < array.size() ? &array[index] : nullptr; }
+    double numberOr(const char* key, double fallback) const
+    {
+        const JsonValue* value = get(key);
+        return value && value->type == Number ? value->number : fallback;
+    }
+    // an index, count or byte offset: a whole number below 2^53, INVALID for anything
+    // else (a negative or huge double converted to size_t is undefined)
+    static constexpr size_t INVALID = ~(size_t)0;
+    size_t toSize() const
+    {
+        return type == Number && number >= 0.0 && number < 9007199254740992.0 && number == std::floor(number)
+                   ? (size_t)number
+                   : INVALID;
+    }
+    size_t sizeOr(const char* key, size_t fallback) const
+    {
+        const JsonValue* value = get(key);
+        return value ? value->toSize() : fallback;
+    }
+};
+
+class JsonParser
+{
+public:
+    JsonParser(const char* begin, const char* end) : p(begin), end(end) {}
+    bool parse(JsonValue& value)
+    {
+        return parseValue(value, 0) && skip() == end;
+    }
+
+private:
+    const char* p;
+    const char* end;
+
+    const char* skip()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+        return p;
+    }
+    bool literal(const char* word)
+    {
+        const size_t length = std::strlen(word);
+        if ((size_t)(end - p) < length || std::memcmp(p, word, length) != 0)
+            return false;
+        p += length;
+        return true;
+    }
+    bool parseString(std::string& out)
+    {
+        if (skip() == end || *p != '"')
+            return false;
+        for (++p; p < end && *p != '"'; ++p)
+        {
+            if (*p != '\\')
+            {
+                out += *p;
+                continue;
+            }
+            if (++p == end)
+                return false;
+            switch (*p)
+            {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': // names and keys glTF reads are ASCII
+                if (end - p < 5)
+                    return false;
+                out += '?';
+                p += 4;
+                break;
+            default: out += *p; break;
+            }
+        }
+        if (p == end)
+            return false;
+        ++p;
+        return true;
+    }
+    bool parseValue(JsonValue& value, int depth)
+    {
+        if (depth > 64 || skip() == end)
+            return false;
+        switch (*p)
+        {
+        case '{':
+            value.type = JsonValue::Object;
+            ++p;
+            if (skip() < end && *p == '}')
+                return ++p, true;
+            for (;;)
+            {
+                value.object.emplace_back();
+                if (!parseString(value.object.back().first) || skip() == end || *p++ != ':' ||
+                    !parseValue(value.object.back().second, depth + 1) || skip() == end)
+                    return false;
+                if (*p == '}')
+                    return ++p, true;
+                if (*p++ != ',')
+                    return false;
+            }
+        case '[':
+            value.type = JsonValue::Array;
+            ++p;
+            if (skip() < end && *p == ']')
+                return ++p, true;
+            for (;;)
+            {
+                value.array.emplace_back();
+                if (!parseValue(value.array.back(), depth + 1) || skip() == end)
+                    return false;
+                if (*p == ']')
+                    return ++p, true;
+                if (*p++ != ',')
+                    return false;
+            }
+        case '"':
+            value.type = JsonValue::String;
+            return parseString(value.string);
+        case 't':
+        case 'f':
+            value.type = JsonValue::Bool;
+            value.boolean = *p == 't';
+            return literal(value.boolean ? "true" : "false");
+        case 'n':
+            return literal("null");
+        default:
+        {
+            float number;
+            const char* next = parseFloat(p, end, number);
+            if (!next)
+                return false;
+            // integers (indices, offsets, counts) exactly, everything else as float is enough
+            int64_t integer;
+            const char* integerEnd = parseInt(p, end, integer);
+            value.type = JsonValue::Number;
+            value.number = integerEnd == next ? (double)integer : (double)number;
+            p = next;
+            return true;
+        }
+        }
+    }
+};
+
+// one accessor of a glTF asset in the BIN chunk
+struct GltfAccessor
+{
+    const unsigned char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    int components = 0;
+    int componentType = 0;
+    bool normalized = false;
+
+    float component(size_t element, int c) const
+    {
+        const unsigned char* at = data + element * stride;
+        switch (componentType)
+        {
+        case 5120: { int8_t v; std::memcpy(&v, at + c, 1); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+        case 5121: return normalized ? at[c] / 255.0f : at[c];
+        case 5122: { int16_t v; std::memcpy(&v, at + c * 2, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+        case 5123: { uint16_t v; std::memcpy(&v, at + c * 2, 2); return normalized ? v / 65535.0f : v; }
+        case 5125: { uint32_t v; std::memcpy(&v, at + c * 4, 4); return (float)v; }
+        default: { float v; std::memcpy(&v, at + c * 4, 4); return v; }
+        }
+    }
+    uint32_t index(size_t element) const
+    {
+        const unsigned char* at = data + element * stride;
+        if (componentType == 5121)
+            return *at;
+        if (componentType == 5123)
+        {
+            uint16_t v;
+            std::memcpy(&v, at, 2);
+            return v;
+        }
+        uint32_t v;
+        std::memcpy(&v, at, 4);
+        return v;
+    }
+};
+
+inline bool gltfAccessor(const JsonValue& gltf, const JsonValue* indexValue, const unsigned char* bin, size_t binSize,
+                         GltfAccessor& accessor)
+{
+    const JsonValue* accessors = gltf.get("accessors");
+    const JsonValue* views = gltf.get("bufferViews");
+    const JsonValue* json = indexValue && accessors ? accessors->at(indexValue->toSize()) : nullptr;
+    if (!json || json->get("sparse"))
+        return false;
+    const JsonValue* view = views ? views->at(json->sizeOr("bufferView", JsonValue::INVALID)) : nullptr;
+    const JsonValue* type = json->get("type");
+    if (!view || !type || view->sizeOr("buffer", 0) != 0)
+        return false;
+    static const char* types[] = {"SCALAR", "VEC2", "VEC3", "VEC4"};
+    accessor.components = 0;
+    for (int i = 0; i < 4; ++i)
+        if (type->string == types[i])
+            accessor.components = i + 1;
+    const size_t componentType = json->sizeOr("componentType", 0);
+    accessor.componentType = componentType <= 5126 ? (int)componentType : 0;
+    const int componentSize = accessor.componentType == 5120 || accessor.componentType == 5121 ? 1
+                            : accessor.componentType == 5122 || accessor.componentType == 5123 ? 2
+                            : accessor.componentType == 5125 || accessor.componentType == 5126 ? 4 : 0;
+    if (!accessor.components || !componentSize)
+        return false;
+    const JsonValue* normalized = json->get("normalized");
+    accessor.normalized = normalized && normalized->boolean;
+    accessor.count = json->sizeOr("count", 0);
+    const size_t elementSize = (size_t)accessor.components * componentSize;
+    accessor.stride = view->sizeOr("byteStride", 0);
+    if (accessor.stride == 0)
+        accessor.stride = elementSize;
+    const size_t viewOffset = view->sizeOr("byteOffset", 0), viewLength = view->sizeOr("byteLength", 0);
+    const size_t offset = json->sizeOr("byteOffset", 0);
+    // every value below 2^53, so sums cannot wrap; the product is checked by division
+    if (accessor.count == JsonValue::INVALID || accessor.stride == JsonValue::INVALID || viewOffset == JsonValue::INVALID ||
+        viewLength == JsonValue::INVALID || offset == JsonValue::INVALID || viewOffset + viewLength > binSize ||
+        (accessor.count && (offset + elementSize > viewLength ||
+                            (accessor.count - 1) > (viewLength - offset - elementSize) / accessor.stride)))
+        return false;
+    accessor.data = bin + viewOffset + offset;
+    return true;
+}
+
+// ------------------------------------------------------------------------
+inline bool loadGlb(const char* data, size_t size, ThreadPool* pool, LoadedMesh& mesh)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto word = [&](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, data + offset, 4);
+        return value;
+    };
+    if (size < 20 || word(0) != 0x46546C67 || word(4) != 2 || word(16) != 0x4E4F534A || 20 + (size_t)word(12) > size)
+    {
+        std::cout << "ERROR::MESH_LOADER::GLB_HEADER: " << mesh.path << std::endl;
+        return false;
+    }
+    const size_t jsonLength = word(12), binHeader = 20 + ((jsonLength + 3) & ~(size_t)3);
+    const unsigned char* bin = nullptr;
+    size_t binSize = 0;
+    if (binHeader + 8 <= size && word(binHeader + 4) == 0x004E4942)
+    {
+        binSize = std::min<size_t>(word(binHeader), size - binHeader - 8);
+        bin = (const unsigned char*)data + binHeader + 8;
+    }
+    JsonValue gltf;
+    if (!JsonParser(data + 20, data + 20 + jsonLength).parse(gltf) || gltf.type != JsonValue::Object)
+    {
+        std::cout << "ERROR::MESH_LOADER::GLB_JSON: " << mesh.path << std::endl;
+        return false;
+    }
+
+    // triangle primitives, each with its place in the output
+    struct Primitive
+    {
+        GltfAccessor position, color, texCoord, indices;
+        bool hasColor, hasTexCoord, indexed;
+        size_t firstVertex, firstIndex;
+    };
+    std::vector<Primitive> primitives;
+    size_t vertexCount = 0, indexCount = 0, skipped = 0;
+    const JsonValue* meshes = gltf.get("meshes");
+    for (size_t m = 0; meshes && m < meshes->array.size(); ++m)
+    {
+        const JsonValue* list = meshes->array[m].get("primitives");
+        for (size_t i = 0; list && i < list->array.size(); ++i)
+        {
+            const JsonValue& json = list->array[i];
+            const JsonValue* attributes = json.get("attributes");
+            Primitive primitive;
+            if (json.numberOr("mode", 4) != 4 || !attributes ||
+                !gltfAccessor(gltf, attributes->get("POSITION"), bin, binSize, primitive.position) ||
+                primitive.position.components < 3 || primitive.position.count == 0)
+            {
+                ++skipped;
+                continue;
+            }
+            // component() does not check c, an accessor with too few components is ignored like a missing one
+            primitive.hasColor = gltfAccessor(gltf, attributes->get("COLOR_0"), bin, binSize, primitive.color) &&
+                                 primitive.color.count == primitive.position.count && primitive.color.components >= 3;
+            primitive.hasTexCoord = gltfAccessor(gltf, attributes->get("TEXCOORD_0"), bin, binSize, primitive.texCoord) &&
+                                    primitive.texCoord.count == primitive.position.count &&
+                                    primitive.texCoord.components >= 2;
+            primitive.indexed = json.get("indices") != nullptr;
+            if (primitive.indexed && (!gltfAccessor(gltf, json.get("indices"), bin, binSize, primitive.indices) ||
+                                      primitive.indices.components != 1))
+            {
+                ++skipped;
+                continue;
+            }
+            primitive.firstVertex = vertexCount;
+            primitive.firstIndex = indexCount;
+            vertexCount += primitive.position.count;
+            indexCount += (primitive.indexed ? primitive.indices.count : primitive.position.count) / 3 * 3;
+            primitives.push_back(primitive);
+        }
+    }
+    if (skipped)
+        std::cout << "ERROR::MESH_LOADER::GLB_SKIPPED_PRIMITIVES: " << skipped
+                  << " (not triangles, empty, sparse or out of the BIN chunk) in " << mesh.path << std::endl;
+    if (primitives.empty() || vertexCount > 0xffffffffu)
+        return false;
+
+    mesh.vertices.resize(vertexCount * LoadedMesh::FLOATS_PER_VERTEX);
+    mesh.indices.resize(indexCount);
+    std::atomic<bool> outOfRange(false);
+    forEach(pool, primitives.size(), [&](size_t i) {
+        const Primitive& primitive = primitives[i];
+        for (size_t v = 0; v < primitive.position.count; ++v)
+        {
+            float* vertex = &mesh.vertices[(primitive.firstVertex + v) * LoadedMesh::FLOATS_PER_VERTEX];
+            for (int c = 0; c < 3; ++c)
+            {
+                vertex[c] = primitive.position.component(v, c);
+                vertex[3 + c] = primitive.hasColor ? primitive.color.component(v, c) : 1.0f;
+            }
+            vertex[6] = primitive.hasTexCoord ? primitive.texCoord.component(v, 0) : 0.0f;
+            vertex[7] = primitive.hasTexCoord ? 1.0f - primitive.texCoord.component(v, 1) : 0.0f;
+        }
+        const size_t count = (primitive.indexed ? primitive.indices.count : primitive.position.count) / 3 * 3;
+        for (size_t k = 0; k < count; ++k)
+        {
+            const uint32_t index = primitive.indexed ? primitive.indices.index(k) : (uint32_t)k;
+            if (index >= primitive.position.count)
+                outOfRange = true;
+            mesh.indices[primitive.firstIndex + k] = (uint32_t)primitive.firstVertex + std::min<uint32_t>(index, (uint32_t)primitive.position.count - 1);
+        }
+    });
+    if (outOfRange)
+        std::cout << "ERROR::MESH_LOADER::GLB_INDEX_OUT_OF_RANGE: clamped in " << mesh.path << std::endl;
+    mesh.parseMs = millisecondsSince(start);
+    return true;
+}
+} // namespace mesh_parse
+
+// `pool`: parse on its workers and the calling thread, null for the calling thread only
+// ------------------------------------------------------------------------
+inline LoadedMesh loadMesh(const std::string& path, ThreadPool* pool = nullptr)
+{
+    auto start = std::chrono::steady_clock::now();
+    LoadedMesh mesh;
+    mesh.path = path;
+    MappedFile file(path);
+    if (!file.isOpen())
+    {
+        std::cout << "ERROR::MESH_LOADER::FILE_NOT_FOUND: " << path << std::endl;
+        return mesh;
+    }
+    mesh.fileBytes = file.size();
+    mesh.mapMs = mesh_parse::millisecondsSince(start);
+    std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+    if (extension == ".obj")
+        mesh.valid = mesh_parse::loadObj(file.data(), file.size(), pool, mesh);
+    else if (extension == ".glb")
+        mesh.valid = mesh_parse::loadGlb(file.data(), file.size(), pool, mesh);
+    else
+        std::cout << "ERROR::MESH_LOADER::UNKNOWN_FORMAT: " << path << std::endl;
+    if (!mesh.valid)
+    {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+    }
+    mesh.totalMs = mesh_parse::millisecondsSince(start);
+    return mesh;
+}
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Reordering passes for indexed triangle lists, meant to run in this order:
+//   optimizeVertexCache  triangle order for the post-transform vertex cache (Forsyth's
+//                        linear-speed optimizer), fewer vertex shader runs per triangle
+//   optimizeOverdraw     splits that order into clusters that each still use the cache
+//                        well and sorts them outward facing first, so less is shaded
+//                        and then hidden (Sander, Nehab & Barczak)
+//   optimizeVertexFetch  renumbers the vertices in the order the triangles use them,
+//                        so the fetches walk the vertex buffer forward
+// analyzeVertexCache() measures an order with a FIFO cache: ACMR, vertex shader runs per
+// triangle (0.5 is the ideal for a regular grid, 3 the worst), and ATVR, runs per
+// vertex (1 is ideal).
+// ------------------------------------------------------------------------
+struct VertexCacheStats
+{
+    size_t triangles = 0;
+    size_t vertices = 0; // referenced by the triangles
+    size_t misses = 0;
+    float acmr() const { return triangles ? (float)misses / triangles : 0.0f; }
+    float atvr() const { return vertices ? (float)misses / vertices : 0.0f; }
+};
+
+inline VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                           size_t cacheSize = 16)
+{
+    VertexCacheStats stats;
+    stats.triangles = indexCount / 3;
+    std::vector<size_t> loadedAt(vertexCount, 0); // miss count when it entered the cache, 0: never
+    std::vector<bool> used(vertexCount, false);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t vertex = indices[i];
+        if (!used[vertex])
+        {
+            used[vertex] = true;
+            ++stats.vertices;
+        }
+        // a FIFO of cacheSize holds the last cacheSize misses
+        if (loadedAt[vertex] == 0 || stats.misses + 1 - loadedAt[vertex] > cacheSize)
+            loadedAt[vertex] = ++stats.misses;
+    }
+    return stats;
+}
+
+namespace mesh_optimize
+{
+const int CACHE_SIZE = 32;
+const int MAX_VALENCE = 32;
+
+// Forsyth's vertex score: the vertices of the last triangle a fixed 0.75, older cache
+// entries falling off with their position, plus a bonus for few remaining triangles
+// so lone triangles do not get left behind
+struct ScoreTable
+{
+    float cache[CACHE_SIZE];
+    float valence[MAX_VALENCE + 1];
+    ScoreTable()
+    {
+        for (int i = 0; i < CACHE_SIZE; ++i)
+            cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (float)(i - 3) / (CACHE_SIZE - 3), 1.5f);
+        valence[0] = 0.0f;
+        for (int i = 1; i <= MAX_VALENCE; ++i)
+            valence[i] = 2.0f / std::sqrt((float)i);
+    }
+    float score(int cachePosition, uint32_t remaining) const
+    {
+        if (remaining == 0)
+            return -1.0f;
+        return (cachePosition >= 0 ? cache[cachePosition] : 0.0f) + valence[std::min<uint32_t>(remaining, MAX_VALENCE)];
+    }
+};
+} // namespace mesh_optimize
+
+// ------------------------------------------------------------------------
+inline void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    using namespace mesh_optimize;
+    static const ScoreTable table;
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+    indexCount = triangleCount * 3;
+
+    // triangles of each vertex (compressed rows), shrinking as triangles are emitted
+    std::vector<uint32_t> remaining(vertexCount, 0), firstTriangle(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; ++i)
+        ++remaining[indices[i]];
+    for (size_t v = 0; v < vertexCount; ++v)
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    std::vector<uint32_t> adjacency(indexCount), filled(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (size_t i = 0; i < indexCount; ++i)
+        adjacency[filled[indices[i]]++] = (uint32_t)(i / 3);
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount), triangleScore(triangleCount, 0.0f);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScore[v] = table.score(-1, remaining[v]);
+    for (size_t t = 0; t < triangleCount; ++t)
+        for (int k = 0; k < 3; ++k)
+            triangleScore[t] += vertexScore[indices[t * 3 + k]];
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+
+    uint32_t cache[CACHE_SIZE + 3];
+    int cacheCount = 0;
+    size_t cursor = 0; // dead ends continue with the first triangle not emitted yet
+    int64_t best = (int64_t)(std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin());
+    while (output.size() < indexCount)
+    {
+        if (best < 0)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best = (int64_t)cursor;
+        }
+        const uint32_t* triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // the triangle's vertices go to the front of the cache, the rest moves back
+        uint32_t next[CACHE_SIZE + 3];
+        int nextCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            // a degenerate triangle is listed once per corner
+            const uint32_t vertex = triangle[k];
+            if (std::find(next, next + nextCount, vertex) == next + nextCount)
+                next[nextCount++] = vertex;
+            uint32_t* first = &adjacency[firstTriangle[vertex]];
+            uint32_t* last = first + remaining[vertex];
+            *std::find(first, last, (uint32_t)best) = *(last - 1);
+            --remaining[vertex];
+        }
+        for (int i = 0; i < cacheCount; ++i)
+            if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+                next[nextCount++] = cache[i];
+
+        // rescore everything in or just pushed out of the cache and its triangles, then
+        // continue with the best of those triangles
+        for (int i = 0; i < nextCount; ++i)
+        {
+            const uint32_t vertex = next[i];
+            cachePosition[vertex] = i < CACHE_SIZE ? i : -1;
+            const float score = table.score(cachePosition[vertex], remaining[vertex]);
+            const float delta = score - vertexScore[vertex];
+            vertexScore[vertex] = score;
+            for (uint32_t j = 0; j < remaining[vertex]; ++j)
+                triangleScore[adjacency[firstTriangle[vertex] + j]] += delta;
+        }
+        best = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < std::min(nextCount, CACHE_SIZE); ++i)
+            for (uint32_t j = 0; j < remaining[next[i]]; ++j)
+            {
+                const uint32_t t = adjacency[firstTriangle[next[i]] + j];
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        cacheCount = std::min(nextCount, CACHE_SIZE);
+        std::memcpy(cache, next, cacheCount * sizeof(uint32_t));
+    }
+    std::memcpy(indices, output.data(), indexCount * sizeof(uint32_t));
+}
+
+// `positions`: a float x, y, z every `stride` bytes. `threshold`: how much worse than
+// the whole order a cluster's cache use may get, larger gives more, smaller clusters
+// to sort and a higher ACMR
+// ------------------------------------------------------------------------
+inline void optimizeOverdraw(uint32_t* indices, size_t indexCount, const void* positions, size_t vertexCount,
+                             size_t stride, float threshold = 1.05f)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+    auto position = [&](uint32_t vertex) { return (const float*)((const unsigned char*)positions + vertex * stride); };
+
+    // a cluster ends once its own ACMR, counted from a cold cache, is within threshold
+    // of the whole order's: starting it cold after reordering then costs little
+    const float target = analyzeVertexCache(indices, indexCount, vertexCount).acmr() * threshold;
+    const size_t cacheSize = 16;
+    std::vector<size_t> clusterStart(1, 0);
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    size_t misses = 0, clusterMisses = 0;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const uint32_t vertex = indices[t * 3 + k];
+            if (loadedAt[vertex] <= misses - clusterMisses || misses + 1 - loadedAt[vertex] > cacheSize)
+            {
+                loadedAt[vertex] = ++misses;
+                ++clusterMisses;
+            }
+        }
+        const size_t clusterTriangles = t + 1 - clusterStart.back();
+        if (t + 1 < triangleCount && (float)clusterMisses / clusterTriangles <= target)
+        {
+            clusterStart.push_back(t + 1);
+            clusterMisses = 0;
+        }
+    }
+    clusterStart.push_back(triangleCount);
+    const size_t clusterCount = clusterStart.size() - 1;
+    if (clusterCount < 2)
+        return;
+
+    // area weighted centroid and normal per cluster; outward facing clusters, seen from
+    // outside the mesh, cover the ones behind them and are drawn first
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f}, meshArea = 0.0f;
+    std::vector<float> clusterData(clusterCount * 6, 0.0f); // centroid * area, normal
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        float* data = &clusterData[c * 6];
+        float area = 0.0f;
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; ++t)
+        {
+            const float* a = position(indices[t * 3]);
+            const float* b = position(indices[t * 3 + 1]);
+            const float* p = position(indices[t * 3 + 2]);
+            const float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            const float e2[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+            const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+            const float triangleArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int i = 0; i < 3; ++i)
+            {
+                data[i] += (a[i] + b[i] + p[i]) / 3.0f * triangleArea;
+                data[3 + i] += n[i];
+            }
+            area += triangleArea;
+        }
+        for (int i = 0; i < 3; ++i)
+            meshCentroid[i] += data[i];
+        meshArea += area;
+        for (int i = 0; i < 3; ++i)
+            data[i] = area > 0.0f ? data[i] / area : position(indices[clusterStart[c] * 3])[i];
+    }
+    for (int i = 0; i < 3; ++i)
+        meshCentroid[i] = meshArea > 0.0f ? meshCentroid[i] / meshArea : 0.0f;
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        const float* data = &clusterData[c * 6];
+        const float length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+        float key = 0.0f;
+        for (int i = 0; i < 3; ++i)
+            key += (data[i] - meshCentroid[i]) * (length > 0.0f ? data[3 + i] / length : 0.0f);
+        sortKey[c] = key;
+    }
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indexCount);
+    for (size_t c : order)
+        output.insert(output.end(), indices + clusterStart[c] * 3, indices + clusterStart[c + 1] * 3);
+    std::memcpy(indices, output.data(), triangleCount * 3 * sizeof(uint32_t));
+}
+
+// reorders the `stride` byte vertices by first use and rewrites the indices; vertices no
+// triangle uses are dropped. Returns the new vertex count
+// ------------------------------------------------------------------------
+inline size_t optimizeVertexFetch(void* vertices, size_t vertexCount, size_t stride, uint32_t* indices, size_t indexCount)
+{
+    const uint32_t unused = ~0u;
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& target = remap[indices[i]];
+        if (target == unused)
+            target = next++;
+        indices[i] = target;
+    }
+    std::vector<unsigned char> reordered((size_t)next * stride);
+    const unsigned char* source = (const unsigned char*)vertices;
+    for (size_t v = 0; v < vertexCount; ++v)
+        if (remap[v] != unused)
+            std::memcpy(&reordered[remap[v] * stride], source + v * stride, stride);
+    std::memcpy(vertices, reordered.data(), reordered.size());
+    return next;
+}
+
+#endif
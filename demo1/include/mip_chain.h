@@ -0,0 +1,291 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_CHAIN_SSE2 1
+#endif
+
+// 8 bit image with interleaved channels (stb_image order: grey, grey+alpha, RGB, RGBA),
+// rows tightly packed
+struct MipImage
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> pixels;
+};
+
+enum class MipFilter
+{
+    Box,    // 2x2 average, what glGenerateMipmap does on most drivers
+    Kaiser  // 8 tap windowed sinc, keeps small levels sharper without ringing much
+};
+
+struct MipOptions
+{
+    MipFilter filter = MipFilter::Box;
+    // the colour channels hold sRGB encoded values: filter them in linear light and
+    // encode the result again, otherwise every level gets darker than it should
+    bool srgb = false;
+    // images with alpha are filtered with premultiplied colour, so fully transparent
+    // texels (whose colour is arbitrary) do not bleed into their neighbours
+    bool premultiplyAlpha = true;
+    // keep the levels premultiplied; by default they are divided back to straight alpha
+    bool storePremultiplied = false;
+    // SSE2/AVX2 paths when the compiler targets them; false forces the scalar code
+    bool simd = true;
+};
+
+namespace mip_detail
+{
+// source texel of output x, tap i: 2 * x + first + i (clamped to the edge)
+struct Kernel
+{
+    int first;
+    int taps;
+    float weights[8];
+};
+
+inline Kernel makeKernel(MipFilter filter)
+{
+    if (filter == MipFilter::Box)
+        return {0, 2, {0.5f, 0.5f}};
+    // sinc for a 2:1 reduction, Kaiser window (alpha 4) over +-4 source texels
+    const double pi = 3.14159265358979323846, alpha = 4.0, radius = 4.0;
+    auto besselI0 = [](double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 20; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    };
+    Kernel kernel = {-3, 8, {}};
+    double total = 0.0, weights[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        double d = (kernel.first + i) - 0.5; // distance from the output texel centre, in source texels
+        double x = d / 2.0;
+        double sinc = std::sin(pi * x) / (pi * x);
+        double window = besselI0(alpha * std::sqrt(1.0 - (d / radius) * (d / radius))) / besselI0(alpha);
+        weights[i] = sinc * window;
+        total += weights[i];
+    }
+    for (int i = 0; i < 8; ++i)
+        kernel.weights[i] = (float)(weights[i] / total);
+    return kernel;
+}
+
+// sRGB byte -> linear float, and linear float (12 bit steps) -> sRGB byte
+struct Tables
+{
+    float toLinear[256];
+    unsigned char toSrgb[4097];
+
+    Tables()
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            double c = i / 255.0;
+            toLinear[i] = (float)(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+        }
+        for (int i = 0; i <= 4096; ++i)
+        {
+            double c = i / 4096.0;
+            double s = c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+            toSrgb[i] = (unsigned char)std::lround(std::min(1.0, std::max(0.0, s)) * 255.0);
+        }
+    }
+    static const Tables& get()
+    {
+        static const Tables tables;
+        return tables;
+    }
+};
+
+inline int alphaChannel(int channels)
+{
+    return channels == 2 || channels == 4 ? channels - 1 : -1;
+}
+
+// one row of bytes -> RGBA floats (linear, premultiplied as requested); a missing alpha is 1
+inline void decodeRow(const unsigned char* in, int width, int channels, const MipOptions& options, float* out)
+{
+    const Tables& tables = Tables::get();
+    const int alpha = alphaChannel(channels);
+    const int colors = alpha < 0 ? channels : channels - 1;
+    const bool premultiply = options.premultiplyAlpha && alpha >= 0;
+    for (int x = 0; x < width; ++x, in += channels, out += 4)
+    {
+        float a = alpha < 0 ? 1.0f : in[alpha] * (1.0f / 255.0f);
+        for (int k = 0; k < 3; ++k)
+        {
+            float c = k < colors ? (options.srgb ? tables.toLinear[in[k]] : in[k] * (1.0f / 255.0f)) : 0.0f;
+            out[k] = premultiply ? c * a : c;
+        }
+        out[3] = a;
+    }
+}
+
+inline unsigned char encodeLinear(float value)
+{
+    return (unsigned char)(std::min(1.0f, std::max(0.0f, value)) * 255.0f + 0.5f);
+}
+
+inline void encodeRow(const float* in, int width, int channels, const MipOptions& options, unsigned char* out)
+{
+    const Tables& tables = Tables::get();
+    const int alpha = alphaChannel(channels);
+    const int colors = alpha < 0 ? channels : channels - 1;
+    const bool unpremultiply = options.premultiplyAlpha && alpha >= 0 && !options.storePremultiplied;
+    for (int x = 0; x < width; ++x, in += 4, out += channels)
+    {
+        float scale = unpremultiply && in[3] > 0.0f ? 1.0f / in[3] : 1.0f;
+        for (int k = 0; k < colors; ++k)
+        {
+            float c = in[k] * scale;
+            out[k] = options.srgb ? tables.toSrgb[(int)(std::min(1.0f, std::max(0.0f, c)) * 4096.0f + 0.5f)] : encodeLinear(c);
+        }
+        if (alpha >= 0)
+            out[alpha] = encodeLinear(in[3]);
+    }
+}
+
+// out[j] = sum over taps of weights[i] * rows[i][j], for `count` floats
+inline void filterRows(const float* const* rows, const float* weights, int taps, int count, float* out, bool simd)
+{
+    int j = 0;
+    if (simd)
+    {
+#if defined(__AVX2__)
+        for (; j + 8 <= count; j += 8)
+        {
+            __m256 sum = _mm256_mul_ps(_mm256_loadu_ps(rows[0] + j), _mm256_set1_ps(weights[0]));
+            for (int i = 1; i < taps; ++i)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[i] + j), _mm256_set1_ps(weights[i])));
+            _mm256_storeu_ps(out + j, sum);
+        }
+#endif
+#if defined(MIP_CHAIN_SSE2)
+        for (; j + 4 <= count; j += 4)
+        {
+            __m128 sum = _mm_mul_ps(_mm_loadu_ps(rows[0] + j), _mm_set1_ps(weights[0]));
+            for (int i = 1; i < taps; ++i)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[i] + j), _mm_set1_ps(weights[i])));
+            _mm_storeu_ps(out + j, sum);
+        }
+#endif
+    }
+    for (; j < count; ++j)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < taps; ++i)
+            sum += rows[i][j] * weights[i];
+        out[j] = sum;
+    }
+}
+
+// horizontal 2:1 reduction of one RGBA float row
+inline void filterColumns(const float* in, int inWidth, const Kernel& kernel, int outWidth, float* out, bool simd)
+{
+    for (int x = 0; x < outWidth; ++x, out += 4)
+    {
+        const int first = 2 * x + kernel.first;
+        const bool inside = first >= 0 && first + kernel.taps <= inWidth;
+#if defined(MIP_CHAIN_SSE2)
+        if (simd)
+        {
+            // one texel is one vector, 4 channels at a time
+            __m128 sum = _mm_setzero_ps();
+            for (int i = 0; i < kernel.taps; ++i)
+            {
+                int sx = inside ? first + i : std::min(std::max(first + i, 0), inWidth - 1);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(in + 4 * sx), _mm_set1_ps(kernel.weights[i])));
+            }
+            _mm_storeu_ps(out, sum);
+            continue;
+        }
+#endif
+        float sum[4] = {};
+        for (int i = 0; i < kernel.taps; ++i)
+        {
+            int sx = inside ? first + i : std::min(std::max(first + i, 0), inWidth - 1);
+            for (int k = 0; k < 4; ++k)
+                sum[k] += in[4 * sx + k] * kernel.weights[i];
+        }
+        for (int k = 0; k < 4; ++k)
+            out[k] = sum[k];
+    }
+    (void)simd;
+}
+} // namespace mip_detail
+
+// next smaller level, sizes follow GL's floor(size / 2). Works a row at a time: the
+// source rows a kernel needs are decoded into a small ring, filtered vertically, then
+// horizontally, so even an 8K level never exists as floats in memory
+// ------------------------------------------------------------------------
+inline MipImage downsample(const MipImage& source, const MipOptions& options = MipOptions())
+{
+    using namespace mip_detail;
+    MipImage level;
+    level.width = std::max(1, source.width / 2);
+    level.height = std::max(1, source.height / 2);
+    level.channels = source.channels;
+    level.pixels.resize((size_t)level.width * level.height * level.channels);
+
+    const Kernel kernel = makeKernel(options.filter);
+    const size_t sourceRow = (size_t)source.width * source.channels;
+    std::vector<float> ring((size_t)kernel.taps * source.width * 4);
+    std::vector<int> ringRow(kernel.taps, -1); // source row held by each ring slot
+    std::vector<float> vertical((size_t)source.width * 4), horizontal((size_t)level.width * 4);
+    const float* rows[8];
+    for (int y = 0; y < level.height; ++y)
+    {
+        for (int i = 0; i < kernel.taps; ++i)
+        {
+            int sy = std::min(std::max(2 * y + kernel.first + i, 0), source.height - 1);
+            int slot = sy % kernel.taps;
+            float* row = ring.data() + (size_t)slot * source.width * 4;
+            if (ringRow[slot] != sy)
+            {
+                decodeRow(source.pixels.data() + sy * sourceRow, source.width, source.channels, options, row);
+                ringRow[slot] = sy;
+            }
+            rows[i] = row;
+        }
+        filterRows(rows, kernel.weights, kernel.taps, source.width * 4, vertical.data(), options.simd);
+        filterColumns(vertical.data(), source.width, kernel, level.width, horizontal.data(), options.simd);
+        encodeRow(horizontal.data(), level.width, level.channels, options,
+                  level.pixels.data() + (size_t)y * level.width * level.channels);
+    }
+    return level;
+}
+
+inline MipImage downsampleBox(const MipImage& source)
+{
+    return downsample(source, MipOptions());
+}
+
+// the base image followed by every smaller level down to 1x1, or `maxLevels` levels
+// at most when it is not 0. Each level is made from the previous one, going through
+// 8 bits in between
+// ------------------------------------------------------------------------
+inline std::vector<MipImage> buildMipChain(MipImage base, const MipOptions& options = MipOptions(), size_t maxLevels = 0)
+{
+    std::vector<MipImage> levels;
+    levels.push_back(std::move(base));
+    while ((levels.back().width > 1 || levels.back().height > 1) && (maxLevels == 0 || levels.size() < maxLevels))
+        levels.push_back(downsample(levels.back(), options));
+    return levels;
+}
+
+#endif
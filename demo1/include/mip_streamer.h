@@ -0,0 +1,281 @@
+#ifndef MIP_STREAMER_H
+#define MIP_STREAMER_H
+
+#include <glad/glad.h>
+
+#include <block_compression.h>
+#include <cooked_texture.h>
+#include <texture_2d.h>
+#include <texture_loader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Mip residency for cooked textures (.ctex, texcook). A texture starts with only its
+// small levels (`startSize` texels and below); the renderer reports how large each
+// texture appears on screen, and update() uploads finer levels straight from the
+// mapped file, one level per texture per frame and `uploadBudget` bytes per frame,
+// while keeping the resident bytes under `budget`. GL_TEXTURE_BASE_LEVEL points at
+// the finest resident level. Finer levels than a texture currently wants are dropped
+// first when memory is needed, textures that were not requested for a while the
+// longest ago first; the small starting levels always stay.
+// Streamed textures keep mutable storage on purpose: glTexStorage2D would allocate
+// every level up front, a level given a 0x0 image here actually frees its memory.
+// ------------------------------------------------------------------------
+class MipStreamer
+{
+public:
+    size_t budget;
+    size_t uploadBudget;
+    int startSize = 64;     // levels up to this size are uploaded by add() and never dropped
+    int holdFrames = 120;   // frames without a request before a texture falls back to its small levels
+
+    struct Stats
+    {
+        size_t residentBytes = 0;
+        size_t pendingLevels = 0;  // wanted levels that are not resident yet
+        size_t uploadedLevels = 0;
+        size_t uploadedBytes = 0;
+        size_t evictedLevels = 0;
+        size_t evictedBytes = 0;
+        size_t deferredByBudget = 0; // uploads skipped because nothing could be evicted
+    };
+
+    explicit MipStreamer(size_t budget = size_t(128) << 20, size_t uploadBudget = size_t(4) << 20)
+        : budget(budget), uploadBudget(uploadBudget)
+    {
+    }
+    ~MipStreamer()
+    {
+        for (auto& entry : textures)
+            glDeleteTextures(1, &entry.first);
+    }
+    MipStreamer(const MipStreamer&) = delete;
+    MipStreamer& operator=(const MipStreamer&) = delete;
+
+    // a new texture holding the small levels of `path`; 0 when the file is missing or invalid.
+    // The texture stays bound to GL_TEXTURE_2D, ready for its wrap and filter parameters
+    // ------------------------------------------------------------------------
+    GLuint add(const std::string& path)
+    {
+        std::unique_ptr<CookedTexture> file(new CookedTexture(path));
+        if (!file->isOpen())
+            return 0;
+        Streamed streamed;
+        streamed.compressedFormat = TextureLoader::compressedFormatFor(file->format());
+        streamed.file = std::move(file);
+        const CookedTexture& cooked = *streamed.file;
+        int tail = (int)cooked.levelCount() - 1;
+        while (tail > 0 && std::max(cooked.level(tail - 1).width, cooked.level(tail - 1).height) <= startSize)
+            --tail;
+        streamed.tail = streamed.base = streamed.wanted = tail;
+
+        glGenTextures(1, &streamed.texture);
+        glBindTexture(GL_TEXTURE_2D, streamed.texture);
+        for (int level = (int)cooked.levelCount() - 1; level >= tail; --level)
+            uploadLevel(streamed, level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, tail);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)cooked.levelCount() - 1);
+        GLuint texture = streamed.texture;
+        textures.emplace(texture, std::move(streamed));
+        return texture;
+    }
+    void remove(GLuint texture)
+    {
+        auto it = textures.find(texture);
+        if (it == textures.end())
+            return;
+        stats.residentBytes -= it->second.bytes;
+        glDeleteTextures(1, &texture);
+        textures.erase(it);
+    }
+    bool contains(GLuint texture) const { return textures.count(texture) != 0; }
+
+    // the texture covers about width x height pixels this frame
+    void request(GLuint texture, float width, float height)
+    {
+        auto it = textures.find(texture);
+        if (it == textures.end())
+            return;
+        const CookedTexture::Level& base = it->second.file->level(0);
+        requestLevel(texture, levelForScreenSize(base.width, base.height, width, height));
+    }
+    void requestLevel(GLuint texture, int level)
+    {
+        auto it = textures.find(texture);
+        if (it == textures.end())
+            return;
+        Streamed& streamed = it->second;
+        // several requests in one frame: the finest wins
+        level = std::min(std::max(level, 0), streamed.tail);
+        streamed.wanted = streamed.lastRequest == frame ? std::min(streamed.wanted, level) : level;
+        streamed.lastRequest = frame;
+    }
+    // the mip level whose texels are about one pixel at that size on screen
+    static int levelForScreenSize(int textureWidth, int textureHeight, float width, float height)
+    {
+        float ratio = std::min(textureWidth / std::max(width, 1.0f), textureHeight / std::max(height, 1.0f));
+        return ratio <= 1.0f ? 0 : (int)std::floor(std::log2(ratio));
+    }
+
+    // once per frame on the GL thread
+    // ------------------------------------------------------------------------
+    void update()
+    {
+        ++frame;
+        std::vector<Streamed*> candidates;
+        for (auto& entry : textures)
+        {
+            Streamed& streamed = entry.second;
+            if (frame - streamed.lastRequest > (uint64_t)holdFrames)
+                streamed.wanted = streamed.tail;
+            if (streamed.base > streamed.wanted)
+                candidates.push_back(&streamed);
+        }
+        // the textures missing the most levels first, then the most recently requested
+        std::sort(candidates.begin(), candidates.end(), [](const Streamed* a, const Streamed* b) {
+            int missingA = a->base - a->wanted, missingB = b->base - b->wanted;
+            return missingA != missingB ? missingA > missingB : a->lastRequest > b->lastRequest;
+        });
+        size_t spent = 0;
+        for (Streamed* streamed : candidates)
+        {
+            const int level = streamed->base - 1;
+            const size_t bytes = levelBytes(*streamed, level);
+            if (spent > 0 && spent + bytes > uploadBudget)
+                break;
+            while (stats.residentBytes + bytes > budget && evictOne(streamed))
+            {
+            }
+            if (stats.residentBytes + bytes > budget)
+            {
+                ++stats.deferredByBudget;
+                continue;
+            }
+            glBindTexture(GL_TEXTURE_2D, streamed->texture);
+            uploadLevel(*streamed, level);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+            streamed->base = level;
+            spent += bytes;
+        }
+        stats.pendingLevels = 0;
+        for (auto& entry : textures)
+            stats.pendingLevels += std::max(entry.second.base - entry.second.wanted, 0);
+    }
+
+    // the finest level currently resident
+    int residentLevel(GLuint texture) const
+    {
+        auto it = textures.find(texture);
+        return it == textures.end() ? -1 : it->second.base;
+    }
+    size_t textureBytes(GLuint texture) const
+    {
+        auto it = textures.find(texture);
+        return it == textures.end() ? 0 : it->second.bytes;
+    }
+    size_t pending() const { return stats.pendingLevels; }
+    const Stats& statistics() const { return stats; }
+
+    void report() const
+    {
+        std::cout << "TEXTURE::STREAMING: " << textures.size() << " textures, " << stats.residentBytes / 1024 << " of "
+                  << budget / 1024 << " KiB resident, " << stats.pendingLevels << " levels pending, "
+                  << stats.uploadedLevels << " uploaded (" << stats.uploadedBytes / 1024 << " KiB), "
+                  << stats.evictedLevels << " evicted (" << stats.evictedBytes / 1024 << " KiB), "
+                  << stats.deferredByBudget << " deferred by the budget" << std::endl;
+    }
+
+private:
+    struct Streamed
+    {
+        std::unique_ptr<CookedTexture> file;
+        GLuint texture = 0;
+        GLenum compressedFormat = 0; // 0: pixels, or blocks decompressed on upload
+        int tail = 0;   // first of the levels that always stay
+        int base = 0;   // finest resident level
+        int wanted = 0; // finest level requested
+        uint64_t lastRequest = 0;
+        size_t bytes = 0;
+    };
+    std::unordered_map<GLuint, Streamed> textures;
+    uint64_t frame = 0;
+    Stats stats;
+
+    size_t levelBytes(const Streamed& streamed, int level) const
+    {
+        const CookedTexture& cooked = *streamed.file;
+        const CookedTexture::Level& data = cooked.level(level);
+        if (cooked.format() != BlockFormat::None && !streamed.compressedFormat)
+            return (size_t)data.width * data.height * 4;
+        return data.size;
+    }
+    // texture bound to GL_TEXTURE_2D
+    void uploadLevel(Streamed& streamed, int level)
+    {
+        const CookedTexture& cooked = *streamed.file;
+        const CookedTexture::Level& data = cooked.level(level);
+        const bool alpha = cooked.channels() == 2 || cooked.channels() == 4;
+        if (cooked.format() == BlockFormat::None)
+        {
+            texture_storage::UnpackLayout layout(data.width, 0, cooked.channels(), data.data);
+            glTexImage2D(GL_TEXTURE_2D, level, texture_storage::sizedFormat(cooked.channels()), data.width, data.height, 0,
+                         texture_storage::pixelFormat(cooked.channels()), GL_UNSIGNED_BYTE, data.data);
+        }
+        else if (streamed.compressedFormat)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, streamed.compressedFormat, data.width, data.height, 0,
+                                   (GLsizei)data.size, data.data);
+        else
+        {
+            MipImage rgba = decompressImage(data.data, data.width, data.height, cooked.format());
+            glTexImage2D(GL_TEXTURE_2D, level, alpha ? GL_RGBA8 : GL_RGB8, data.width, data.height, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, rgba.pixels.data());
+        }
+        const size_t bytes = levelBytes(streamed, level);
+        streamed.bytes += bytes;
+        stats.residentBytes += bytes;
+        ++stats.uploadedLevels;
+        stats.uploadedBytes += bytes;
+    }
+    // drop the finest level of the texture that has the most levels beyond what it wants
+    // (the one requested longest ago among equals); false when there is none besides `keep`
+    bool evictOne(const Streamed* keep)
+    {
+        Streamed* victim = nullptr;
+        for (auto& entry : textures)
+        {
+            Streamed& streamed = entry.second;
+            if (&streamed == keep || streamed.base >= streamed.wanted)
+                continue;
+            int surplus = streamed.wanted - streamed.base;
+            if (!victim || surplus > victim->wanted - victim->base ||
+                (surplus == victim->wanted - victim->base && streamed.lastRequest < victim->lastRequest))
+                victim = &streamed;
+        }
+        if (!victim)
+            return false;
+        const int level = victim->base;
+        const size_t bytes = levelBytes(*victim, level);
+        glBindTexture(GL_TEXTURE_2D, victim->texture);
+        // base level first so the texture never refers to a freed level
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+        if (victim->compressedFormat)
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, victim->compressedFormat, 0, 0, 0, 0, NULL);
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        victim->base = level + 1;
+        victim->bytes -= bytes;
+        stats.residentBytes -= bytes;
+        ++stats.evictedLevels;
+        stats.evictedBytes += bytes;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef POST_DECODE_H
+#define POST_DECODE_H
+
+#include <mip_chain.h>
+
+#include <cstring>
+#include <utility>
+
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <tmmintrin.h>
+#define POST_DECODE_SSSE3 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POST_DECODE_SSE2 1
+#endif
+
+// Everything between stb_image's output and the upload, in one sweep over the
+// image: vertical flip (by reading the source rows bottom up, instead of stb's
+// row swap pass), RGB -> RGBA expansion, red/blue swap and alpha premultiplication.
+// Each destination row is written once while its source row is still in cache.
+// ------------------------------------------------------------------------
+struct PostDecodeOptions
+{
+    bool flipVertically = false;
+    int outputChannels = 0;       // 0 keeps the source's; 4 expands grey/RGB to RGBA
+    bool swapRedBlue = false;     // BGRA uploads
+    bool premultiplyAlpha = false;
+    bool simd = true;             // SSE2 row paths (SSSE3 byte shuffles when the compiler targets them)
+};
+
+namespace post_decode_detail
+{
+// x * a / 255 rounded, exact for 8 bit x and a
+inline unsigned char multiply255(unsigned int x, unsigned int a)
+{
+    unsigned int t = x * a + 128;
+    return (unsigned char)((t + (t >> 8)) >> 8);
+}
+
+inline void convertRowScalar(const unsigned char* in, int width, int inChannels, int outChannels,
+                             const PostDecodeOptions& options, unsigned char* out)
+{
+    const bool inAlpha = inChannels == 2 || inChannels == 4;
+    for (int x = 0; x < width; ++x, in += inChannels, out += outChannels)
+    {
+        unsigned char r, g, b, a = inAlpha ? in[inChannels - 1] : 255;
+        if (inChannels <= 2)
+            r = g = b = in[0];
+        else
+        {
+            r = in[0];
+            g = in[1];
+            b = in[2];
+        }
+        if (options.premultiplyAlpha && inAlpha)
+        {
+            r = multiply255(r, a);
+            g = multiply255(g, a);
+            b = multiply255(b, a);
+        }
+        if (options.swapRedBlue)
+            std::swap(r, b);
+        if (outChannels <= 2)
+        {
+            out[0] = r;
+            if (outChannels == 2)
+                out[1] = a;
+        }
+        else
+        {
+            out[0] = r;
+            out[1] = g;
+            out[2] = b;
+            if (outChannels == 4)
+                out[3] = a;
+        }
+    }
+}
+
+#if defined(POST_DECODE_SSE2)
+// 4 RGBA texels: colour channels times alpha / 255, alpha unchanged
+inline __m128i premultiply4(__m128i texels)
+{
+    const __m128i zero = _mm_setzero_si128(), bias = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000u);
+    __m128i lo = _mm_unpacklo_epi8(texels, zero), hi = _mm_unpackhi_epi8(texels, zero);
+    // broadcast each texel's alpha over its four 16 bit lanes
+    __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+    __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+    lo = _mm_add_epi16(_mm_mullo_epi16(lo, alphaLo), bias);
+    hi = _mm_add_epi16(_mm_mullo_epi16(hi, alphaHi), bias);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+    __m128i result = _mm_packus_epi16(lo, hi);
+    return _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, texels));
+}
+
+// 4 RGBA texels: bytes 0 and 2 of every texel exchanged
+inline __m128i swapRedBlue4(__m128i texels)
+{
+#if defined(POST_DECODE_SSSE3)
+    return _mm_shuffle_epi8(texels, _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+#else
+    // red and blue are 16 bits apart, a rotate of each 32 bit lane by 16 moves them into each other's place
+    const __m128i redBlue = _mm_and_si128(texels, _mm_set1_epi32(0x00FF00FF));
+    const __m128i greenAlpha = _mm_andnot_si128(_mm_set1_epi32(0x00FF00FF), texels);
+    return _mm_or_si128(greenAlpha, _mm_or_si128(_mm_slli_epi32(redBlue, 16), _mm_srli_epi32(redBlue, 16)));
+#endif
+}
+
+// the first 12 bytes of source (4 RGB texels) -> 4 opaque RGBA texels
+inline __m128i expandRgb4(__m128i source)
+{
+    const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+#if defined(POST_DECODE_SSSE3)
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm_or_si128(_mm_shuffle_epi8(source, expand), opaque);
+#else
+    // the low dword of the source shifted by 0, 3, 6 and 9 bytes holds texel 0..3 (plus one byte
+    // of the next texel, which the alpha OR overwrites); gather those four dwords
+    const __m128i texels01 = _mm_unpacklo_epi32(source, _mm_srli_si128(source, 3));
+    const __m128i texels23 = _mm_unpacklo_epi32(_mm_srli_si128(source, 6), _mm_srli_si128(source, 9));
+    return _mm_or_si128(_mm_unpacklo_epi64(texels01, texels23), opaque);
+#endif
+}
+#endif
+
+// RGBA -> RGBA (swap, premultiply) and RGB -> RGBA, 4 texels per step; returns texels done.
+// Plain SSE2 covers every path (any x86-64 build); SSSE3 only swaps the byte moves for pshufb
+inline int convertRowSimd(const unsigned char* in, int width, int inChannels, int outChannels,
+                          const PostDecodeOptions& options, unsigned char* out)
+{
+    int x = 0;
+#if defined(POST_DECODE_SSE2)
+    if (inChannels == 4 && outChannels == 4)
+    {
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i texels = _mm_loadu_si128((const __m128i*)(in + 4 * x));
+            if (options.premultiplyAlpha)
+                texels = premultiply4(texels);
+            if (options.swapRedBlue)
+                texels = swapRedBlue4(texels);
+            _mm_storeu_si128((__m128i*)(out + 4 * x), texels);
+        }
+    }
+    else if (inChannels == 3 && outChannels == 4)
+    {
+        // 12 source bytes -> 4 texels; the 16 byte load reads 4 bytes ahead, so the
+        // last texels of the row are left to the scalar code
+        for (; x + 6 <= width; x += 4)
+        {
+            __m128i texels = expandRgb4(_mm_loadu_si128((const __m128i*)(in + 3 * x)));
+            if (options.swapRedBlue)
+                texels = swapRedBlue4(texels);
+            _mm_storeu_si128((__m128i*)(out + 4 * x), texels);
+        }
+    }
+#endif
+    (void)in;
+    (void)width;
+    (void)inChannels;
+    (void)outChannels;
+    (void)options;
+    (void)out;
+    return x;
+}
+} // namespace post_decode_detail
+
+// the whole stage; with no option set it is a plain copy
+// ------------------------------------------------------------------------
+inline MipImage postDecode(const unsigned char* pixels, int width, int height, int channels, const PostDecodeOptions& options)
+{
+    using namespace post_decode_detail;
+    MipImage image;
+    image.width = width;
+    image.height = height;
+    image.channels = options.outputChannels > 0 ? options.outputChannels : channels;
+    image.pixels.resize((size_t)width * height * image.channels);
+    const size_t inRow = (size_t)width * channels, outRow = (size_t)width * image.channels;
+    const bool copyOnly = image.channels == channels && !options.swapRedBlue &&
+                          !(options.premultiplyAlpha && (channels == 2 || channels == 4));
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char* in = pixels + (size_t)(options.flipVertically ? height - 1 - y : y) * inRow;
+        unsigned char* out = image.pixels.data() + (size_t)y * outRow;
+        if (copyOnly)
+        {
+            std::memcpy(out, in, inRow);
+            continue;
+        }
+        int done = options.simd ? convertRowSimd(in, width, channels, image.channels, options, out) : 0;
+        convertRowScalar(in + (size_t)done * channels, width - done, channels, image.channels, options,
+                         out + (size_t)done * image.channels);
+    }
+    return image;
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <fnv1a.h>
+#include <gl_ext.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed by both sources, the defines and the driver strings, so a driver
+// update simply misses; a blob the driver rejects anyway is counted and recompiled.
+// Create it after glext::load(), it is disabled when program binaries are unsupported.
+class ProgramBinaryCache
+{
+public:
+    int hits = 0;
+    int misses = 0;
+    int rejected = 0;             // entries found on disk but truncated, oversized or refused by glProgramBinary
+    double secondsSaved = 0.0;    // recorded compile time of hits minus their load time
+
+    explicit ProgramBinaryCache(const std::string& directory)
+        : directory(directory)
+    {
+        if (!enabled())
+            return;
+        driver = std::string((const char*)glGetString(GL_VENDOR)) + "|" +
+                 (const char*)glGetString(GL_RENDERER) + "|" +
+                 (const char*)glGetString(GL_VERSION);
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error)
+            std::cout << "ERROR::PROGRAM_CACHE::CANNOT_CREATE_DIRECTORY: " << directory << " " << error.message() << std::endl;
+    }
+
+    bool enabled() const
+    {
+        return glext::functions().programBinary;
+    }
+    // key from the fnv1a64 of each stage's file contents (before defines are spliced in)
+    // ------------------------------------------------------------------------
+    uint64_t makeKey(uint64_t vertexHash, uint64_t fragmentHash, const std::string& defines) const
+    {
+        uint64_t key = fnv1a64((const char*)&vertexHash, sizeof(vertexHash));
+        key = fnv1a64((const char*)&fragmentHash, sizeof(fragmentHash), key);
+        key = fnv1a64(defines, key);
+        key = fnv1a64("\0", 1, key);
+        return fnv1a64(driver, key);
+    }
+    // call before glLinkProgram on a miss so the driver keeps the binary around
+    void prepareForStore(GLuint program) const
+    {
+        if (enabled())
+            glext::functions().ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    // try to link program from the cache; true on hit, the program is then ready to use
+    // ------------------------------------------------------------------------
+    bool load(uint64_t key, GLuint program)
+    {
+        if (!enabled())
+            return false;
+        auto start = std::chrono::steady_clock::now();
+        std::ifstream file(entryPath(key), std::ios::binary);
+        EntryHeader header;
+        if (!file || !file.read((char*)&header, sizeof(header)) || header.magic != MAGIC)
+        {
+            ++misses;
+            return false;
+        }
+        // the length comes from disk: a store() entry is exactly header + blob, anything else is damaged
+        const std::streampos blobStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streamoff remaining = file.tellg() - blobStart;
+        file.seekg(blobStart);
+        if (header.length == 0 || header.length > MAX_BLOB_LENGTH || remaining != (std::streamoff)header.length)
+        {
+            ++rejected;
+            ++misses;
+            return false;
+        }
+        std::vector<char> blob(header.length);
+        if (!file.read(blob.data(), blob.size()))
+        {
+            ++misses;
+            return false;
+        }
+        glext::functions().ProgramBinary(program, header.format, blob.data(), (GLsizei)blob.size());
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            ++rejected;
+            ++misses;
+            return false;
+        }
+        ++hits;
+        secondsSaved += header.compileSeconds -
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+    // write the binary of a freshly linked program; compileSeconds is what a later hit saves
+    // ------------------------------------------------------------------------
+    void store(uint64_t key, GLuint program, double compileSeconds)
+    {
+        if (!enabled())
+            return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0 || (uint32_t)length > MAX_BLOB_LENGTH)
+            return;
+        std::vector<char> blob(length);
+        EntryHeader header;
+        glext::functions().GetProgramBinary(program, length, NULL, &header.format, blob.data());
+        header.length = (uint32_t)length;
+        header.compileSeconds = compileSeconds;
+        // write to a temporary and rename, a crash never leaves a truncated entry behind
+        std::string path = entryPath(key);
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write((const char*)&header, sizeof(header));
+            file.write(blob.data(), blob.size());
+            if (!file)
+            {
+                std::cout << "ERROR::PROGRAM_CACHE::WRITE_FAILED: " << temporary << std::endl;
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out) const
+    {
+        if (!enabled())
+        {
+            out << "program cache: disabled (no program binary support)" << std::endl;
+            return;
+        }
+        out << "program cache: " << hits << " hits, " << misses << " misses";
+        if (rejected)
+            out << " (" << rejected << " rejected)";
+        out << ", " << secondsSaved * 1000.0 << " ms saved" << std::endl;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x31434250; // "PBC1"
+    static const uint32_t MAX_BLOB_LENGTH = 64u << 20; // far above any driver's program binary
+    struct EntryHeader
+    {
+        uint32_t magic = MAGIC;
+        GLenum format = 0;
+        uint32_t length = 0;
+        uint32_t reserved = 0;
+        double compileSeconds = 0.0;
+    };
+
+    std::string directory;
+    std::string driver;
+
+    std::string entryPath(uint64_t key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory + "/" + name;
+    }
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SHADER_FILES_H
+#define SHADER_FILES_H
+
+#include <mapped_file.h>
+
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+
+// All shader sources below a directory, memory mapped in one pass at startup.
+// Views returned by find() stay valid as long as the set lives and go to
+// Shader::fromSource / Shader::deferredFromSource without being copied.
+// ------------------------------------------------------------------------
+class ShaderFileSet
+{
+public:
+    size_t totalBytes = 0;
+
+    explicit ShaderFileSet(const std::string& directory)
+        : root(directory)
+    {
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            if (!it->is_regular_file())
+                continue;
+            MappedFile file(it->path().string());
+            if (!file.isOpen())
+            {
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << it->path().string() << std::endl;
+                continue;
+            }
+            totalBytes += file.size();
+            // keys are relative to the directory with '/' separators, e.g. "4.2.texture.vs"
+            std::string name = std::filesystem::relative(it->path(), directory).generic_string();
+            files.emplace(name, std::move(file));
+        }
+        if (error)
+            std::cout << "ERROR::SHADER::CANNOT_LIST_DIRECTORY: " << directory << " " << error.message() << std::endl;
+    }
+
+    // map a file again after it changed on disk (hot reload); views handed out
+    // for it before are invalid afterwards. A file that is gone is dropped
+    // ------------------------------------------------------------------------
+    bool reload(const std::string& name)
+    {
+        auto it = files.find(name);
+        if (it != files.end())
+        {
+            totalBytes -= it->second.size();
+            files.erase(it);
+        }
+        MappedFile file(root + "/" + name);
+        if (!file.isOpen())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << root << "/" << name << std::endl;
+            return false;
+        }
+        totalBytes += file.size();
+        files.emplace(name, std::move(file));
+        return true;
+    }
+    bool contains(const std::string& name) const
+    {
+        return files.count(name) != 0;
+    }
+    // empty view (and an error message) for unknown names
+    std::string_view find(const std::string& name) const
+    {
+        auto it = files.find(name);
+        if (it == files.end())
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << root << "/" << name << std::endl;
+            return std::string_view();
+        }
+        return it->second.view();
+    }
+    size_t size() const
+    {
+        return files.size();
+    }
+    const std::string& directory() const
+    {
+        return root;
+    }
+
+private:
+    std::string root;
+    std::map<std::string, MappedFile> files;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include <shader_preprocessor.h>
+#include <shader_s.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compiled programs per (expanded vertex source, expanded fragment source, define set).
+// Variants of one uber shader ("one texture" vs "two texture mix") are selected with
+// defines at build time instead of runtime branches or copies of the file. Programs
+// are submitted deferred, so the first use() of a new permutation waits for it.
+// ------------------------------------------------------------------------
+class ShaderPermutations
+{
+public:
+    int builds = 0;
+    int lookups = 0;
+    int reloads = 0;
+    // called after a reloaded program replaced the old one, e.g. to set sampler units again
+    std::function<void(Shader&)> onReload;
+
+    ShaderPermutations(ShaderPreprocessor& preprocessor, ProgramBinaryCache* cache = nullptr)
+        : preprocessor(preprocessor), cache(cache)
+    {
+    }
+
+    // the returned reference stays valid for the lifetime of the cache, reloads included
+    // ------------------------------------------------------------------------
+    Shader& get(const std::string& vertexName, const std::string& fragmentName, const ShaderDefines& defines = ShaderDefines())
+    {
+        ++lookups;
+        const ExpandedSource& vertex = preprocessor.expand(vertexName);
+        const ExpandedSource& fragment = preprocessor.expand(fragmentName);
+        std::string defineText = definesToString(defines);
+        uint64_t key = permutationKey(vertex.hash, fragment.hash, defineText);
+        auto it = programs.find(key);
+        if (it != programs.end())
+            return it->second.shader;
+        ++builds;
+        Permutation permutation{
+            Shader::deferredFromSource(ShaderCode(vertex.text, vertex.hash), ShaderCode(fragment.text, fragment.hash), cache, defineText),
+            vertexName, fragmentName, defineText, vertex.dependencies};
+        permutation.dependencies.insert(permutation.dependencies.end(), fragment.dependencies.begin(), fragment.dependencies.end());
+        return programs.emplace(key, std::move(permutation)).first->second.shader;
+    }
+    // submit a new build for every program that uses one of the changed files; the
+    // preprocessor must already have dropped its expansions of them
+    // ------------------------------------------------------------------------
+    void rebuild(const std::vector<std::string>& changed)
+    {
+        for (auto& entry : programs)
+        {
+            const Permutation& permutation = entry.second;
+            bool affected = false;
+            for (const std::string& name : changed)
+                affected = affected || std::find(permutation.dependencies.begin(), permutation.dependencies.end(), name) != permutation.dependencies.end();
+            if (!affected)
+                continue;
+            const ExpandedSource& vertex = preprocessor.expand(permutation.vertexName);
+            const ExpandedSource& fragment = preprocessor.expand(permutation.fragmentName);
+            PendingReload reload{
+                entry.first, permutationKey(vertex.hash, fragment.hash, permutation.defines),
+                Shader::deferredFromSource(ShaderCode(vertex.text, vertex.hash), ShaderCode(fragment.text, fragment.hash), cache, permutation.defines),
+                vertex.dependencies};
+            reload.dependencies.insert(reload.dependencies.end(), fragment.dependencies.begin(), fragment.dependencies.end());
+            // a newer save supersedes a build that is still running
+            for (auto it = pending.begin(); it != pending.end(); ++it)
+            {
+                if (it->key == reload.key)
+                {
+                    glDeleteProgram(it->candidate.ID);
+                    pending.erase(it);
+                    break;
+                }
+            }
+            pending.push_back(std::move(reload));
+        }
+    }
+    // swap in rebuilt programs that are done; never waits on a build the driver reports
+    // as still compiling. A program that fails to link is dropped, the old one stays
+    // ------------------------------------------------------------------------
+    void applyReloads()
+    {
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (!it->candidate.isReady())
+            {
+                ++it;
+                continue;
+            }
+            if (!it->candidate.isLinked())
+            {
+                std::cout << "SHADER::RELOAD_FAILED, keeping the previous program" << std::endl;
+                glDeleteProgram(it->candidate.ID);
+                it = pending.erase(it);
+                continue;
+            }
+            auto node = programs.extract(it->key);
+            if (node.empty())
+            {
+                glDeleteProgram(it->candidate.ID);
+                it = pending.erase(it);
+                continue;
+            }
+            Permutation& permutation = node.mapped();
+            // uniforms keep the values the application set on the old program
+            it->candidate.adoptUniformValues(permutation.shader);
+            glDeleteProgram(permutation.shader.ID);
+            permutation.shader = it->candidate;
+            permutation.dependencies = it->dependencies;
+            // re-key under the new sources; the node keeps its address, so references from get() stay valid
+            node.key() = it->newKey;
+            auto inserted = programs.insert(std::move(node));
+            if (!inserted.inserted)
+            {
+                inserted.node.key() = it->key;
+                programs.insert(std::move(inserted.node));
+            }
+            ++reloads;
+            if (onReload)
+                onReload(programs.find(inserted.inserted ? it->newKey : it->key)->second.shader);
+            it = pending.erase(it);
+        }
+    }
+    size_t size() const
+    {
+        return programs.size();
+    }
+    template <typename Function>
+    void forEach(Function function)
+    {
+        for (auto& entry : programs)
+            function(entry.second.shader);
+    }
+
+private:
+    struct Permutation
+    {
+        Shader shader;
+        std::string vertexName;
+        std::string fragmentName;
+        std::string defines;
+        std::vector<std::string> dependencies; // every file either stage was expanded from
+    };
+    struct PendingReload
+    {
+        uint64_t key;
+        uint64_t newKey;
+        Shader candidate;
+        std::vector<std::string> dependencies;
+    };
+
+    ShaderPreprocessor& preprocessor;
+    ProgramBinaryCache* cache;
+    std::unordered_map<uint64_t, Permutation> programs;
+    std::vector<PendingReload> pending;
+
+    static uint64_t permutationKey(uint64_t vertexHash, uint64_t fragmentHash, const std::string& defineText)
+    {
+        uint64_t key = fnv1a64((const char*)&vertexHash, sizeof(vertexHash));
+        key = fnv1a64((const char*)&fragmentHash, sizeof(fragmentHash), key);
+        return fnv1a64(defineText, key);
+    }
+};
+
+#endif
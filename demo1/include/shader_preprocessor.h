@@ -0,0 +1,186 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <fnv1a.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// #define sets that select a shader permutation, e.g. {{"TEXTURE_COUNT", "2"}};
+// kept sorted so the same set always gives the same text and hash
+typedef std::map<std::string, std::string> ShaderDefines;
+
+inline std::string definesToString(const ShaderDefines& defines)
+{
+    std::string text;
+    for (const auto& define : defines)
+        text += "#define " + define.first + (define.second.empty() ? "" : " ") + define.second + "\n";
+    return text;
+}
+
+// One file with its #include directives resolved.
+struct ExpandedSource
+{
+    std::string_view text;                  // points into storage, or straight at the loaded file when it has no #include
+    uint64_t hash = 0;                      // fnv1a64 of text
+    std::vector<std::string> dependencies;  // the file itself first, then every included file; index = #line source string number
+    std::string storage;
+};
+
+// Resolves #include "file" (relative to the including file, names as in the loader)
+// and #pragma once, emitting #line directives so compile errors point at the right file.
+// Conditionals are left to the GLSL compiler, so an #include is expanded even inside
+// an #if that the defines turn off. Every file is expanded once and kept.
+// ------------------------------------------------------------------------
+class ShaderPreprocessor
+{
+public:
+    // returns the contents of a file by name, empty if it does not exist
+    typedef std::function<std::string_view(const std::string& name)> Loader;
+
+    explicit ShaderPreprocessor(Loader loader)
+        : loader(std::move(loader))
+    {
+    }
+
+    const ExpandedSource& expand(const std::string& name)
+    {
+        auto it = expanded.find(name);
+        if (it != expanded.end())
+            return it->second;
+        ExpandedSource& result = expanded[name];
+        std::string_view source = loader(name);
+        if (source.find("#include") == std::string_view::npos)
+        {
+            // nothing to resolve, hand the loaded file out as is
+            result.text = source;
+            result.dependencies.push_back(name);
+        }
+        else
+        {
+            std::vector<std::string> stack;
+            std::vector<std::string> once;
+            append(name, source, result, stack, once);
+            result.text = result.storage;
+        }
+        result.hash = fnv1a64(result.text.data(), result.text.size());
+        return result;
+    }
+
+    // forget every expansion that used the file, call it before the loader's
+    // memory for that file changes
+    // ------------------------------------------------------------------------
+    void invalidate(const std::string& name)
+    {
+        for (auto it = expanded.begin(); it != expanded.end();)
+        {
+            const std::vector<std::string>& dependencies = it->second.dependencies;
+            if (std::find(dependencies.begin(), dependencies.end(), name) != dependencies.end())
+                it = expanded.erase(it);
+            else
+                ++it;
+        }
+    }
+
+private:
+    static const int MAX_INCLUDE_DEPTH = 32;
+
+    Loader loader;
+    std::unordered_map<std::string, ExpandedSource> expanded;
+
+    // ------------------------------------------------------------------------
+    void append(const std::string& name, std::string_view source, ExpandedSource& out,
+                std::vector<std::string>& stack, std::vector<std::string>& once)
+    {
+        int sourceNumber = dependencyIndex(out, name);
+        stack.push_back(name);
+        int lineNumber = 0;
+        size_t position = 0;
+        while (position < source.size())
+        {
+            size_t end = source.find('\n', position);
+            std::string_view line = source.substr(position, end == std::string_view::npos ? std::string_view::npos : end - position);
+            position = end == std::string_view::npos ? source.size() : end + 1;
+            ++lineNumber;
+
+            std::string_view directive = trimLeft(line);
+            if (directive.substr(0, 8) == "#include")
+            {
+                std::string included = resolve(name, directive.substr(8));
+                if (included.empty())
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE in " << name << "(" << lineNumber << "): " << line << std::endl;
+                }
+                else if (std::find(stack.begin(), stack.end(), included) != stack.end() || (int)stack.size() >= MAX_INCLUDE_DEPTH)
+                {
+                    std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE in " << name << "(" << lineNumber << "): " << included << std::endl;
+                }
+                else if (std::find(once.begin(), once.end(), included) == once.end())
+                {
+                    std::string_view child = loader(included);
+                    out.storage += "#line 1 " + std::to_string(dependencyIndex(out, included)) + "\n";
+                    append(included, child, out, stack, once);
+                    if (!out.storage.empty() && out.storage.back() != '\n')
+                        out.storage += '\n';
+                    out.storage += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceNumber) + "\n";
+                    continue;
+                }
+                out.storage += '\n'; // keep the line count
+                continue;
+            }
+            if (isPragmaOnce(directive))
+            {
+                once.push_back(name);
+                out.storage += '\n';
+                continue;
+            }
+            out.storage.append(line.data(), line.size());
+            if (end != std::string_view::npos)
+                out.storage += '\n';
+        }
+        stack.pop_back();
+    }
+    // ------------------------------------------------------------------------
+    static int dependencyIndex(ExpandedSource& out, const std::string& name)
+    {
+        for (size_t i = 0; i < out.dependencies.size(); ++i)
+            if (out.dependencies[i] == name)
+                return (int)i;
+        out.dependencies.push_back(name);
+        return (int)out.dependencies.size() - 1;
+    }
+    // "file" or <file> after #include, relative to the directory of the including file
+    static std::string resolve(const std::string& including, std::string_view argument)
+    {
+        argument = trimLeft(argument);
+        if (argument.empty() || (argument[0] != '"' && argument[0] != '<'))
+            return std::string();
+        char close = argument[0] == '"' ? '"' : '>';
+        size_t end = argument.find(close, 1);
+        if (end == std::string_view::npos || end == 1)
+            return std::string();
+        std::filesystem::path path = std::filesystem::path(including).parent_path() / std::string(argument.substr(1, end - 1));
+        return path.lexically_normal().generic_string();
+    }
+    static bool isPragmaOnce(std::string_view directive)
+    {
+        if (directive.substr(0, 7) != "#pragma")
+            return false;
+        directive = trimLeft(directive.substr(7));
+        return directive.substr(0, 4) == "once";
+    }
+    static std::string_view trimLeft(std::string_view text)
+    {
+        size_t first = text.find_first_not_of(" \t");
+        return first == std::string_view::npos ? std::string_view() : text.substr(first);
+    }
+};
+
+#endif
@@ -3,97 +3,614 @@
 
 #include <glad/glad.h>
 
+#include <embedded_shaders.h>
+#include <fnv1a.h>
+#include <mapped_file.h>
+#include <program_cache.h>
+
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+// one active uniform of a linked program, found by glGetActiveUniform
+struct UniformInfo
+{
+    uint32_t hash;     // fnv1a32 of the name, arrays are stored without the "[0]" suffix
+    GLint    location;
+    GLenum   type;
+    GLint    size;     // number of array elements, 1 for plain uniforms
+    uint32_t offset;   // first 4 byte word of its values in the shadow copy
+    uint32_t words;    // 4 byte words per element
+    bool     dirty;
+};
+
+// uniform set counters of one program since the last resetUniformStats()
+struct UniformStats
+{
+    int sets = 0;       // set*/setX calls that reached the shadow copy
+    int redundant = 0;  // of those, how many wrote the value it already had (no GL call)
+    int uploads = 0;    // glUniform* calls made by flush()
+};
+
+// typed handle to a uniform: an index into Shader's uniform table, so setting
+// it per frame is an array access plus the glUniform* call picked by T. The name
+// hash is kept so a handle still finds its uniform after the program was reloaded
+template <typename T>
+struct UniformHandle
+{
+    int index = -1;
+    uint32_t hash = 0;
+    bool valid() const { return index >= 0; }
+};
+
+// source text of one stage and its fnv1a64, which embedded shaders already know
+// at build time; other sources are hashed when a program binary cache needs the key
+struct ShaderCode
+{
+    std::string_view text;
+    uint64_t hash = 0;
+    bool hashed = false;
+
+    ShaderCode(std::string_view text) : text(text) {}
+    ShaderCode(const char* text) : text(text) {}
+    ShaderCode(const std::string& text) : text(text) {}
+    ShaderCode(std::string_view text, uint64_t hash) : text(text), hash(hash), hashed(true) {}
+    ShaderCode(const EmbeddedShader& embedded) : text(embedded.view()), hash(embedded.hash), hashed(true) {}
+
+    uint64_t contentHash() const
+    {
+        return hashed ? hash : fnv1a64(text.data(), text.size());
+    }
+};
+
 class Shader{
 public:
     unsigned int ID;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
+        : Shader(vertexPath, fragmentPath, nullptr)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+    }
+    // same, but looks the linked program up in a binary cache first; defines
+    // ("#define A 1\n...") are inserted after the #version line and are part of the key
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, ProgramBinaryCache* cache, const std::string& defines = "")
+        : ID(0)
+    {
+        submit(vertexPath, fragmentPath, cache, defines);
+        finish();
+    }
+    // non-blocking build: compile and link are only submitted to the driver. Submit every
+    // program first, then poll isReady() or just use() them; with KHR_parallel_shader_compile
+    // the driver compiles them on its own threads meanwhile
+    // ------------------------------------------------------------------------
+    static Shader deferred(const char* vertexPath, const char* fragmentPath, ProgramBinaryCache* cache = nullptr, const std::string& defines = "")
+    {
+        Shader shader;
+        shader.submit(vertexPath, fragmentPath, cache, defines);
+        return shader;
+    }
+    // build from sources already in memory (a ShaderFileSet, embedded arrays, ...),
+    // the views only need to live until the call returns
+    // ------------------------------------------------------------------------
+    static Shader fromSource(ShaderCode vertexCode, ShaderCode fragmentCode, ProgramBinaryCache* cache = nullptr, const std::string& defines = "")
+    {
+        Shader shader = deferredFromSource(vertexCode, fragmentCode, cache, defines);
+        shader.finish();
+        return shader;
+    }
+    static Shader deferredFromSource(ShaderCode vertexCode, ShaderCode fragmentCode, ProgramBinaryCache* cache = nullptr, const std::string& defines = "")
+    {
+        Shader shader;
+        shader.submitSource(vertexCode, fragmentCode, cache, defines);
+        return shader;
+    }
+    // true when finish() will not wait on the driver; without the parallel compile
+    // extension there is no way to ask, so a pending build always reports ready
+    // ------------------------------------------------------------------------
+    bool isReady() const
+    {
+        if (!pending.active || !glext::functions().parallelShaderCompile)
+            return true;
+        GLint done = GL_FALSE;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+    // wait for a submitted build, report its errors and reflect the uniforms
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        if (!pending.active)
+            return;
+        pending.active = false;
+        checkCompileErrors(pending.vertex, "VERTEX");
+        checkCompileErrors(pending.fragment, "FRAGMENT");
+        linked = checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+        // for deferred builds this also counts the time the driver spent while we did other work
+        if (linked && pending.cache)
+            pending.cache->store(pending.cacheKey, ID, std::chrono::duration<double>(std::chrono::steady_clock::now() - pending.start).count());
+        // enumerate the active uniforms once, so setting them never asks the driver by name
+        reflectUniforms();
+    }
+    bool isLinked()
+    {
+        finish();
+        return linked;
     }
-    // activate the shader
+    // activate the shader, the first use of a deferred shader waits for its build;
+    // uniforms set while it was not bound are uploaded now
     // ------------------------------------------------------------------------
     void use() 
     { 
+        finish();
         glUseProgram(ID); 
+        flush();
     }
-    // utility uniform functions
+    // uniform sets write a CPU shadow copy and skip values that did not change. A changed
+    // value goes to GL at once while this program is bound, like glUniform*; set on an
+    // unbound program it waits for the next use(). With batchUploads the changed values
+    // are only marked dirty until use() or flush(), which uploads each of them once
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    bool batchUploads = false;
+    void flush()
+    {
+        for (int index : dirtyUniforms)
+        {
+            UniformInfo& u = uniforms[index];
+            upload(u);
+            u.dirty = false;
+            ++stats.uploads;
+        }
+        dirtyUniforms.clear();
+    }
+    const UniformStats& uniformStats() const
+    {
+        return stats;
+    }
+    void resetUniformStats()
+    {
+        stats = UniformStats();
+    }
+    // take over the values set on another build of the same shader (hot reload),
+    // uniforms that kept their name, type and size get dirty and are uploaded on next use
+    // ------------------------------------------------------------------------
+    void adoptUniformValues(const Shader& other)
+    {
+        for (const UniformInfo& from : other.uniforms)
+        {
+            int index = findUniform(from.hash);
+            if (index < 0 || uniforms[index].type != from.type || uniforms[index].size != from.size)
+                continue;
+            UniformInfo& to = uniforms[index];
+            const uint32_t* source = other.shadow.data() + from.offset;
+            uint32_t* target = shadow.data() + to.offset;
+            size_t words = (size_t)to.words * to.size;
+            if (std::memcmp(source, target, words * 4) != 0)
+            {
+                std::memcpy(target, source, words * 4);
+                markDirty(index);
+            }
+        }
+    }
+    // uniform table lookup; resolve handles once (e.g. getUniform<int>("texture1"_uh))
+    // and keep them, the table is sorted by name hash
+    // ------------------------------------------------------------------------
+    template <typename T>
+    UniformHandle<T> getUniform(uint32_t nameHash)
+    {
+        finish();
+        UniformHandle<T> handle;
+        handle.index = findUniform(nameHash);
+        handle.hash = nameHash;
+        return handle;
+    }
+    template <typename T>
+    UniformHandle<T> getUniform(const std::string &name)
+    {
+        return getUniform<T>(fnv1a32(name));
+    }
+    const std::vector<UniformInfo>& activeUniforms()
+    {
+        finish();
+        return uniforms;
+    }
+    // set a uniform through its handle, invalid handles are ignored like location -1
+    // ------------------------------------------------------------------------
+    void set(UniformHandle<bool> uniform, bool value)
+    {
+        finish();
+        if (uniform.valid())
+            write(handleIndex(uniform.index, uniform.hash), 0, (int)value);
+    }
+    void set(UniformHandle<int> uniform, int value)
+    {
+        finish();
+        if (uniform.valid())
+            write(handleIndex(uniform.index, uniform.hash), 0, value);
+    }
+    void set(UniformHandle<float> uniform, float value)
+    {
+        finish();
+        if (uniform.valid())
+            write(handleIndex(uniform.index, uniform.hash), 0, value);
+    }
+    // utility uniform functions, "name[2]" addresses an array element
+    // ------------------------------------------------------------------------
+    void setBool(const std::string &name, bool value)
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        writeByName(name, (int)value); 
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(const std::string &name, int value)
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        writeByName(name, value); 
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setFloat(const std::string &name, float value)
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        writeByName(name, value); 
+    }
+    // vec2 / vec3 / vec4, matrices and float arrays: `count` floats from the first element on
+    // ------------------------------------------------------------------------
+    void setFloats(const std::string &name, const float* values, size_t count)
+    {
+        finish();
+        const int index = findUniform(fnv1a32(name));
+        if (index < 0)
+            return;
+        const UniformInfo& u = uniforms[index];
+        count = std::min(count, (size_t)u.words * u.size);
+        ++stats.sets;
+        uint32_t* slot = shadow.data() + u.offset;
+        if (std::memcmp(slot, values, count * 4) == 0)
+        {
+            ++stats.redundant;
+            return;
+        }
+        std::memcpy(slot, values, count * 4);
+        changed(index);
     }
 
 private:
+    // shader objects and cache state of a build that was submitted but not finished yet
+    struct PendingBuild
+    {
+        bool active = false;
+        unsigned int vertex = 0;
+        unsigned int fragment = 0;
+        ProgramBinaryCache* cache = nullptr;
+        uint64_t cacheKey = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    std::vector<UniformInfo> uniforms;
+    std::vector<uint32_t> shadow;      // last value of every uniform, read back from GL after linking
+    std::vector<int> dirtyUniforms;    // indices into uniforms, each at most once
+    UniformStats stats;
+    PendingBuild pending;
+    bool linked = false;
+
+    Shader() : ID(0) {}
+
+    // one stage as the pieces handed to glShaderSource: the file itself, with the
+    // defines spliced in after #version, pointing into the caller's memory
+    struct StageSource
+    {
+        const GLchar* strings[5];
+        GLint lengths[5];
+        GLsizei count = 0;
+
+        void add(std::string_view piece)
+        {
+            strings[count] = piece.data();
+            lengths[count] = (GLint)piece.size();
+            ++count;
+        }
+    };
+
+    // map both files and submit them; the mappings can go away once glShaderSource has copied them
+    // ------------------------------------------------------------------------
+    void submit(const char* vertexPath, const char* fragmentPath, ProgramBinaryCache* cache, const std::string& defines)
+    {
+        // 1. retrieve the vertex/fragment source code from filePath
+        MappedFile vShaderFile(vertexPath);
+        MappedFile fShaderFile(fragmentPath);
+        if (!vShaderFile.isOpen())
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << vertexPath << std::endl;
+        if (!fShaderFile.isOpen())
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << fragmentPath << std::endl;
+        submitSource(vShaderFile.view(), fShaderFile.view(), cache, defines);
+    }
+    // hand compile + link to the driver without querying any status, so nothing here
+    // waits for the compiler
+    // ------------------------------------------------------------------------
+    void submitSource(const ShaderCode& vertexCode, const ShaderCode& fragmentCode, ProgramBinaryCache* cache, std::string defines)
+    {
+        if (!defines.empty() && defines.back() != '\n')
+            defines += '\n';
+        StageSource vertexSource = splitSource(vertexCode.text, defines);
+        StageSource fragmentSource = splitSource(fragmentCode.text, defines);
+        // 2. try the program binary cache
+        ID = glCreateProgram();
+        pending = PendingBuild();
+        if (cache && cache->enabled())
+        {
+            pending.cache = cache;
+            pending.cacheKey = cache->makeKey(vertexCode.contentHash(), fragmentCode.contentHash(), defines);
+            if (cache->load(pending.cacheKey, ID))
+            {
+                linked = true;
+                reflectUniforms();
+                return;
+            }
+            // a rejected blob leaves the program in a failed state, start from a fresh one
+            glDeleteProgram(ID);
+            ID = glCreateProgram();
+            cache->prepareForStore(ID);
+        }
+        pending.start = std::chrono::steady_clock::now();
+        // 3. compile shaders
+        // vertex shader
+        pending.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending.vertex, vertexSource.count, vertexSource.strings, vertexSource.lengths);
+        glCompileShader(pending.vertex);
+        // fragment Shader
+        pending.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending.fragment, fragmentSource.count, fragmentSource.strings, fragmentSource.lengths);
+        glCompileShader(pending.fragment);
+        // shader Program
+        glAttachShader(ID, pending.vertex);
+        glAttachShader(ID, pending.fragment);
+        glLinkProgram(ID);
+        pending.active = true;
+    }
+    // "#define ..." lines go right after the #version directive, which must stay first,
+    // followed by a #line so compile errors keep the file's line numbers; defines has
+    // to end with a newline
+    // ------------------------------------------------------------------------
+    static StageSource splitSource(std::string_view code, const std::string& defines)
+    {
+        StageSource source;
+        if (defines.empty())
+        {
+            source.add(code);
+            return source;
+        }
+        size_t insertAt = 0;
+        if (code.substr(0, 8) == "#version")
+        {
+            insertAt = code.find('\n');
+            insertAt = insertAt == std::string_view::npos ? code.size() : insertAt + 1;
+        }
+        source.add(code.substr(0, insertAt));
+        if (insertAt > 0 && code[insertAt - 1] != '\n')
+            source.add("\n");
+        source.add(defines);
+        source.add(insertAt > 0 ? "#line 2\n" : "#line 1\n");
+        source.add(code.substr(insertAt));
+        return source;
+    }
+    // fill the uniform table from GL_ACTIVE_UNIFORMS, sorted by name hash
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniforms.clear();
+        shadow.clear();
+        dirtyUniforms.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> name(maxLength > 0 ? maxLength : 1);
+        std::vector<std::vector<uint32_t>> values; // per uniform in reflection order, until the offsets are known
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+            GLint location = glGetUniformLocation(ID, name.data());
+            if (location < 0)
+                continue; // members of uniform blocks have no location
+            // arrays are reported as "name[0]", index them by "name"
+            if (length > 3 && std::strcmp(name.data() + length - 3, "[0]") == 0)
+                length -= 3;
+            // the shadow starts with what GL holds: zero, or the initializer in the GLSL source
+            const uint32_t words = componentCount(type);
+            values.emplace_back((size_t)words * size);
+            for (GLint element = 0; element < size; ++element)
+            {
+                GLint at = location;
+                if (element > 0)
+                    at = glGetUniformLocation(ID, (std::string(name.data(), (size_t)length) + "[" + std::to_string(element) + "]").c_str());
+                if (at >= 0)
+                    readUniform(type, at, values.back().data() + (size_t)element * words);
+            }
+            // the reflection index rides in offset until the table is sorted
+            uniforms.push_back({fnv1a32(name.data(), (size_t)length), location, type, size, (uint32_t)(values.size() - 1), words, false});
+        }
+        std::sort(uniforms.begin(), uniforms.end(),
+                  [](const UniformInfo& a, const UniformInfo& b) { return a.hash < b.hash; });
+        for (UniformInfo& u : uniforms)
+        {
+            const std::vector<uint32_t>& value = values[u.offset];
+            u.offset = (uint32_t)shadow.size();
+            shadow.insert(shadow.end(), value.begin(), value.end());
+        }
+        dirtyUniforms.clear();
+        for (size_t i = 1; i < uniforms.size(); ++i)
+            if (uniforms[i].hash == uniforms[i - 1].hash)
+                std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION at locations " << uniforms[i - 1].location
+                          << " and " << uniforms[i].location << std::endl;
+    }
+    // ------------------------------------------------------------------------
+    int findUniform(uint32_t nameHash) const
+    {
+        auto it = std::lower_bound(uniforms.begin(), uniforms.end(), nameHash,
+                                   [](const UniformInfo& u, uint32_t hash) { return u.hash < hash; });
+        if (it == uniforms.end() || it->hash != nameHash)
+            return -1;
+        return (int)(it - uniforms.begin());
+    }
+    // the handle's slot normally still holds its uniform; only after a reload
+    // changed the table does it take the binary search again
+    // ------------------------------------------------------------------------
+    int handleIndex(int index, uint32_t hash) const
+    {
+        if ((size_t)index < uniforms.size() && uniforms[index].hash == hash)
+            return index;
+        return findUniform(hash);
+    }
+    // store one 4 byte value into the shadow copy, dirty only if it changed
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void write(int index, int element, T value)
+    {
+        static_assert(sizeof(T) == 4, "uniform shadow values are 4 byte words");
+        if (index < 0 || element < 0 || element >= uniforms[index].size)
+            return;
+        ++stats.sets;
+        uint32_t* slot = shadow.data() + uniforms[index].offset + (size_t)element * uniforms[index].words;
+        if (std::memcmp(slot, &value, 4) == 0)
+        {
+            ++stats.redundant;
+            return;
+        }
+        std::memcpy(slot, &value, 4);
+        changed(index);
+    }
+    void changed(int index)
+    {
+        markDirty(index);
+        if (!batchUploads && isBound())
+            flush();
+    }
+    bool isBound() const
+    {
+        GLint current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+        return current != 0 && (GLuint)current == ID;
+    }
+    template <typename T>
+    void writeByName(const std::string &name, T value)
+    {
+        finish();
+        // "name[k]": element k of the array uniform "name"
+        int element = 0;
+        size_t bracket = name.size() > 3 && name.back() == ']' ? name.rfind('[') : std::string::npos;
+        if (bracket != std::string::npos)
+        {
+            element = std::atoi(name.c_str() + bracket + 1);
+            write(findUniform(fnv1a32(name.data(), bracket)), element, value);
+            return;
+        }
+        write(findUniform(fnv1a32(name)), 0, value);
+    }
+    void markDirty(int index)
+    {
+        if (!uniforms[index].dirty)
+        {
+            uniforms[index].dirty = true;
+            dirtyUniforms.push_back(index);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void upload(const UniformInfo& u) const
+    {
+        const uint32_t* values = shadow.data() + u.offset;
+        const GLfloat* f = (const GLfloat*)values;
+        const GLint* i = (const GLint*)values;
+        const GLuint* ui = (const GLuint*)values;
+        switch (u.type)
+        {
+        case GL_FLOAT:             glUniform1fv(u.location, u.size, f); break;
+        case GL_FLOAT_VEC2:        glUniform2fv(u.location, u.size, f); break;
+        case GL_FLOAT_VEC3:        glUniform3fv(u.location, u.size, f); break;
+        case GL_FLOAT_VEC4:        glUniform4fv(u.location, u.size, f); break;
+        case GL_FLOAT_MAT2:        glUniformMatrix2fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3:        glUniformMatrix3fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4:        glUniformMatrix4fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT2x3:      glUniformMatrix2x3fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3x2:      glUniformMatrix3x2fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT2x4:      glUniformMatrix2x4fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4x2:      glUniformMatrix4x2fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT3x4:      glUniformMatrix3x4fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_FLOAT_MAT4x3:      glUniformMatrix4x3fv(u.location, u.size, GL_FALSE, f); break;
+        case GL_UNSIGNED_INT:      glUniform1uiv(u.location, u.size, ui); break;
+        case GL_UNSIGNED_INT_VEC2: glUniform2uiv(u.location, u.size, ui); break;
+        case GL_UNSIGNED_INT_VEC3: glUniform3uiv(u.location, u.size, ui); break;
+        case GL_UNSIGNED_INT_VEC4: glUniform4uiv(u.location, u.size, ui); break;
+        case GL_INT_VEC2: case GL_BOOL_VEC2: glUniform2iv(u.location, u.size, i); break;
+        case GL_INT_VEC3: case GL_BOOL_VEC3: glUniform3iv(u.location, u.size, i); break;
+        case GL_INT_VEC4: case GL_BOOL_VEC4: glUniform4iv(u.location, u.size, i); break;
+        case GL_INT: case GL_BOOL:
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+                                   glUniform1iv(u.location, u.size, i); break;
+        default:
+            std::cout << "ERROR::SHADER::UNIFORM_TYPE_NOT_SUPPORTED: 0x" << std::hex << u.type << std::dec
+                      << " at location " << u.location << std::endl;
+            break;
+        }
+    }
+    // one element's current value from GL, as 4 byte words
+    void readUniform(GLenum type, GLint location, uint32_t* words) const
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+            glGetUniformuiv(ID, location, (GLuint*)words);
+            break;
+        case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+        case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+        case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT2x4:
+        case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+            glGetUniformfv(ID, location, (GLfloat*)words);
+            break;
+        default: // int, bool and samplers
+            glGetUniformiv(ID, location, (GLint*)words);
+            break;
+        }
+    }
+    // 4 byte words of one element of a uniform type
+    static uint32_t componentCount(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: return 4;
+        case GL_FLOAT_MAT2: return 4;
+        case GL_FLOAT_MAT3: return 9;
+        case GL_FLOAT_MAT4: return 16;
+        case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 6;
+        case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 8;
+        case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 12;
+        default: return 1;
+        }
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    bool checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
         char infoLog[1024];
@@ -115,6 +632,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef SHADER_WARMUP_H
+#define SHADER_WARMUP_H
+
+#include <glad/glad.h>
+
+#include <shader_permutations.h>
+#include <shader_s.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// Shader warm-up for a loading screen. Linking is not the whole build: many drivers
+// only generate the final machine code on the first draw, for the vertex layout and
+// state of that draw. Register every program and every vertex layout (VAO) the game
+// draws with, then call step() once per loading frame: each program is finished and
+// drawn once per layout into a 1x1 offscreen target, at most `budgetMs` per call,
+// so neither the loading screen nor the first gameplay frames hitch.
+// ------------------------------------------------------------------------
+class ShaderWarmup
+{
+public:
+    ShaderWarmup() = default;
+    ~ShaderWarmup()
+    {
+        releaseTarget();
+    }
+    ShaderWarmup(const ShaderWarmup&) = delete;
+    ShaderWarmup& operator=(const ShaderWarmup&) = delete;
+
+    void addProgram(Shader& shader)
+    {
+        programs.push_back(&shader);
+    }
+    // every program built so far by a permutation cache
+    void addPrograms(ShaderPermutations& permutations)
+    {
+        permutations.forEach([&](Shader& shader) { addProgram(shader); });
+    }
+    // the VAO must have enough vertices for one triangle (and an index buffer of `indexType`
+    // for indexed layouts, 0 for none)
+    void addLayout(GLuint vao, GLenum indexType = 0)
+    {
+        layouts.push_back({vao, indexType});
+    }
+
+    // warm up programs until the budget is used up; true once everything is done.
+    // A program still compiling on the driver's threads is skipped until a later frame
+    // ------------------------------------------------------------------------
+    bool step(double budgetMs)
+    {
+        if (done())
+            return true;
+        auto start = std::chrono::steady_clock::now();
+        auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(); };
+        ++frames;
+        GLint previousFramebuffer = 0, previousProgram = 0, previousVao = 0, viewport[4];
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        if (!target && !createTarget())
+        {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+            return true;
+        }
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVao);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+        glViewport(0, 0, 1, 1);
+
+        size_t checked = 0;
+        while (next < programs.size() && checked < programs.size() - next && elapsedMs() < budgetMs)
+        {
+            Shader& shader = *programs[next];
+            if (!shader.isReady())
+            {
+                // to the back of the pending ones, the others move up a place, so every
+                // pending program is looked at once before this one comes round again
+                std::rotate(programs.begin() + next, programs.begin() + next + 1, programs.end());
+                ++checked;
+                continue;
+            }
+            checked = 0;
+            if (shader.isLinked())
+            {
+                shader.use();
+                for (const Layout& layout : layouts)
+                {
+                    glBindVertexArray(layout.vao);
+                    if (layout.indexType)
+                        glDrawElements(GL_TRIANGLES, 3, layout.indexType, 0);
+                    else
+                        glDrawArrays(GL_TRIANGLES, 0, 3);
+                }
+                ++draws;
+            }
+            ++next;
+        }
+        // the draws have to reach the driver now, not on the first gameplay frame
+        glFlush();
+
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glUseProgram(previousProgram);
+        glBindVertexArray(previousVao);
+        totalMs += elapsedMs();
+        if (done())
+        {
+            releaseTarget();
+            std::cout << "SHADER::WARMUP: " << draws << " programs x " << layouts.size() << " layouts in "
+                      << totalMs << " ms over " << frames << " frames" << std::endl;
+        }
+        return done();
+    }
+    bool done() const
+    {
+        return next >= programs.size();
+    }
+    // 0..1 for a progress bar
+    float progress() const
+    {
+        return programs.empty() ? 1.0f : (float)next / (float)programs.size();
+    }
+
+private:
+    struct Layout
+    {
+        GLuint vao;
+        GLenum indexType;
+    };
+
+    std::vector<Shader*> programs;
+    std::vector<Layout> layouts;
+    size_t next = 0; // programs before this index are warm
+    int draws = 0;
+    int frames = 0;
+    double totalMs = 0.0;
+    GLuint target = 0;
+    GLuint color = 0;
+
+    bool createTarget()
+    {
+        glGenRenderbuffers(1, &color);
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+        glGenFramebuffers(1, &target);
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!complete)
+        {
+            std::cout << "ERROR::SHADER_WARMUP::FRAMEBUFFER_INCOMPLETE" << std::endl;
+            releaseTarget();
+            next = programs.size();
+        }
+        return complete;
+    }
+    void releaseTarget()
+    {
+        if (target)
+            glDeleteFramebuffers(1, &target);
+        if (color)
+            glDeleteRenderbuffers(1, &color);
+        target = color = 0;
+    }
+};
+
+#endif
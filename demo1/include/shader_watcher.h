@@ -0,0 +1,153 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <shader_files.h>
+#include <shader_permutations.h>
+#include <shader_preprocessor.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <map>
+#endif
+
+// Non-blocking watch of a directory tree for saved files (inotify on Linux).
+// poll() returns the names that changed since the last call, relative to the
+// directory like ShaderFileSet names; on other platforms it never reports anything.
+// ------------------------------------------------------------------------
+class ShaderWatcher
+{
+public:
+    explicit ShaderWatcher(const std::string& directory)
+    {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+        {
+            std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+            return;
+        }
+        watch(directory, "");
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            if (it->is_directory())
+                watch(it->path().string(), std::filesystem::relative(it->path(), directory).generic_string() + "/");
+        }
+#else
+        (void)directory;
+#endif
+    }
+    ~ShaderWatcher()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // ------------------------------------------------------------------------
+    std::vector<std::string> poll()
+    {
+        std::vector<std::string> changed;
+#ifdef __linux__
+        if (fd < 0)
+            return changed;
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0)
+                break; // EAGAIN: nothing (more) to read
+            for (char* at = buffer; at < buffer + length;)
+            {
+                const inotify_event* event = (const inotify_event*)at;
+                at += sizeof(inotify_event) + event->len;
+                auto dir = directories.find(event->wd);
+                if (event->len == 0 || dir == directories.end() || (event->mask & IN_ISDIR))
+                    continue;
+                std::string name = dir->second + event->name;
+                if (std::find(changed.begin(), changed.end(), name) == changed.end())
+                    changed.push_back(name);
+            }
+        }
+#endif
+        return changed;
+    }
+
+private:
+#ifdef __linux__
+    int fd = -1;
+    std::map<int, std::string> directories; // watch descriptor -> prefix relative to the root
+
+    void watch(const std::string& path, const std::string& prefix)
+    {
+        // editors either write in place (CLOSE_WRITE) or write a temporary and rename it over (MOVED_TO)
+        int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0)
+            std::cout << "ERROR::SHADER_WATCHER::CANNOT_WATCH: " << path << std::endl;
+        else
+            directories[wd] = prefix;
+    }
+#endif
+};
+
+// Shader hot reload: call update() once per frame. Changed files are mapped again,
+// the programs using them are rebuilt deferred, and each one replaces its Shader::ID
+// only once it linked, so the frame keeps drawing the old program meanwhile and a
+// broken edit never shows. Without KHR_parallel_shader_compile the driver cannot be
+// asked whether a build is done, so the swap then waits for the compile once.
+// ------------------------------------------------------------------------
+class ShaderHotReload
+{
+public:
+    ShaderHotReload(ShaderFileSet& files, ShaderPreprocessor& preprocessor, ShaderPermutations& permutations)
+        : files(files), preprocessor(preprocessor), permutations(permutations), watcher(files.directory())
+    {
+    }
+
+    void update()
+    {
+        std::vector<std::string> changed = watcher.poll();
+        // editor swap and backup files are not ours
+        changed.erase(std::remove_if(changed.begin(), changed.end(),
+                                     [&](const std::string& name) { return !files.contains(name) && !isShaderFile(name); }),
+                      changed.end());
+        if (!changed.empty())
+        {
+            for (const std::string& name : changed)
+            {
+                // drop the expansions before their memory is unmapped
+                preprocessor.invalidate(name);
+                files.reload(name);
+                std::cout << "SHADER::CHANGED: " << name << std::endl;
+            }
+            permutations.rebuild(changed);
+        }
+        permutations.applyReloads();
+    }
+
+private:
+    ShaderFileSet& files;
+    ShaderPreprocessor& preprocessor;
+    ShaderPermutations& permutations;
+    ShaderWatcher watcher;
+
+    static bool isShaderFile(const std::string& name)
+    {
+        std::string extension = std::filesystem::path(name).extension().string();
+        return extension == ".vs" || extension == ".fs" || extension == ".glsl";
+    }
+};
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef TEXTURE_2D_H
+#define TEXTURE_2D_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+#include <mip_chain.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Texture allocation and uploads without the implicit parts of glTexImage2D: sized
+// internal formats, every level allocated once up front (glTexStorage2D when the
+// driver has it, so the texture is immutable and never re-validated or reallocated),
+// and the unpack alignment / row length set from the actual data instead of
+// relying on GL_UNPACK_ALIGNMENT happening to fit.
+// ------------------------------------------------------------------------
+namespace texture_storage
+{
+// sized formats for 8 bit images with 1 to 4 channels
+inline GLenum sizedFormat(int channels, bool srgb = false)
+{
+    switch (channels)
+    {
+    case 1: return GL_R8;
+    case 2: return GL_RG8;
+    case 3: return srgb ? GL_SRGB8 : GL_RGB8;
+    default: return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+inline GLenum pixelFormat(int channels)
+{
+    static const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    return formats[channels - 1];
+}
+// the pixel format glTexImage2D needs to allocate a sized internal format without data
+inline GLenum baseFormat(GLenum internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_R8: case GL_R16F: case GL_R32F: return GL_RED;
+    case GL_RG8: case GL_RG16F: case GL_RG32F: return GL_RG;
+    case GL_RGB8: case GL_SRGB8: case GL_RGB16F: case GL_RGB32F: return GL_RGB;
+    case GL_DEPTH_COMPONENT16: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: return GL_DEPTH_COMPONENT;
+    case GL_DEPTH24_STENCIL8: return GL_DEPTH_STENCIL;
+    default: return GL_RGBA;
+    }
+}
+inline int bytesPerPixel(GLenum format, GLenum type)
+{
+    int components = format == GL_RED || format == GL_DEPTH_COMPONENT ? 1
+                   : format == GL_RG ? 2
+                   : format == GL_RGB || format == GL_BGR ? 3 : 4;
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+    case GL_UNSIGNED_INT_24_8: return 4;
+    default: return components * 4;
+    }
+}
+// levels down to 1x1: floor(log2(max(width, height))) + 1
+inline int fullMipCount(int width, int height)
+{
+    int levels = 1;
+    for (int size = width > height ? width : height; size > 1; size /= 2)
+        ++levels;
+    return levels;
+}
+
+// allocate `levels` levels for the texture bound to GL_TEXTURE_2D; true when the
+// storage is immutable. Without texture storage every level is a glTexImage2D
+// without data and GL_TEXTURE_MAX_LEVEL keeps the texture complete
+// ------------------------------------------------------------------------
+inline bool allocate(int levels, GLenum internalFormat, int width, int height)
+{
+    const glext::Functions& f = glext::functions();
+    if (f.textureStorage)
+    {
+        f.TexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+        return true;
+    }
+    const GLenum format = baseFormat(internalFormat);
+    const GLenum type = format == GL_DEPTH_STENCIL ? GL_UNSIGNED_INT_24_8 : GL_UNSIGNED_BYTE;
+    for (int level = 0; level < levels; ++level)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, format, type, NULL);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    return false;
+}
+
+// Unpack state for one upload, back to GL's defaults (alignment 4, row length 0) when it
+// goes out of scope; demo1 never leaves other values set, so nothing has to be queried.
+// The alignment is the largest of 8, 4, 2, 1 that the row pitch and the start address
+// (or buffer offset) both allow, the row length is only set for rows with a gap
+// ------------------------------------------------------------------------
+class UnpackLayout
+{
+public:
+    UnpackLayout(int width, int rowLength, int bytesPerPixel, const void* pixels)
+    {
+        const size_t pitch = (size_t)(rowLength > 0 ? rowLength : width) * bytesPerPixel;
+        const uintptr_t address = (uintptr_t)pixels;
+        alignment = 8;
+        while (alignment > 1 && (pitch % alignment != 0 || address % alignment != 0))
+            alignment /= 2;
+        if (alignment != 4)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+        this->rowLength = rowLength > 0 && rowLength != width ? rowLength : 0;
+        if (this->rowLength)
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, this->rowLength);
+    }
+    ~UnpackLayout()
+    {
+        if (alignment != 4)
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (rowLength)
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    UnpackLayout(const UnpackLayout&) = delete;
+    UnpackLayout& operator=(const UnpackLayout&) = delete;
+
+private:
+    int alignment;
+    int rowLength;
+};
+} // namespace texture_storage
+
+// A GL_TEXTURE_2D with its size, format and mip count fixed at creation. Contents go
+// in with update(), whole levels or any sub-rectangle, e.g. streaming a region that
+// changed every frame without touching the rest.
+// ------------------------------------------------------------------------
+class Texture2D
+{
+public:
+    GLuint ID = 0;
+
+    Texture2D() = default;
+    // levels 0: the full chain down to 1x1
+    Texture2D(int width, int height, GLenum internalFormat, int levels = 0)
+        : textureWidth(width), textureHeight(height), levelCount(levels > 0 ? levels : texture_storage::fullMipCount(width, height)),
+          format(internalFormat)
+    {
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D, ID);
+        immutable = texture_storage::allocate(levelCount, internalFormat, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    // a mip chain (mip_chain.h) as one texture, levels largest first
+    static Texture2D fromLevels(const std::vector<MipImage>& levels, bool srgb = false)
+    {
+        if (levels.empty())
+            return Texture2D();
+        Texture2D texture(levels[0].width, levels[0].height, texture_storage::sizedFormat(levels[0].channels, srgb),
+                          (int)levels.size());
+        for (size_t i = 0; i < levels.size(); ++i)
+            texture.update(levels[i], (int)i);
+        return texture;
+    }
+    ~Texture2D()
+    {
+        if (ID)
+            glDeleteTextures(1, &ID);
+    }
+    Texture2D(Texture2D&& other) noexcept { *this = std::move(other); }
+    Texture2D& operator=(Texture2D&& other) noexcept
+    {
+        std::swap(ID, other.ID);
+        std::swap(textureWidth, other.textureWidth);
+        std::swap(textureHeight, other.textureHeight);
+        std::swap(levelCount, other.levelCount);
+        std::swap(format, other.format);
+        std::swap(immutable, other.immutable);
+        return *this;
+    }
+    Texture2D(const Texture2D&) = delete;
+    Texture2D& operator=(const Texture2D&) = delete;
+
+    // width x height texels at (x, y) of `level`. `rowLength` is the source's row length in
+    // pixels when the rectangle is cut out of a wider image (0: rows are `width` long);
+    // `pixels` may be a GL_PIXEL_UNPACK_BUFFER offset
+    // ------------------------------------------------------------------------
+    void update(int level, int x, int y, int width, int height, GLenum pixelFormat, GLenum type, const void* pixels,
+                int rowLength = 0)
+    {
+        if (!checkRegion(level, x, y, width, height))
+            return;
+        glBindTexture(GL_TEXTURE_2D, ID);
+        texture_storage::UnpackLayout layout(width, rowLength, texture_storage::bytesPerPixel(pixelFormat, type), pixels);
+        glTexSubImage2D(GL_TEXTURE_2D, level, x, y, width, height, pixelFormat, type, pixels);
+    }
+    // the whole image at (x, y)
+    void update(const MipImage& image, int level = 0, int x = 0, int y = 0)
+    {
+        update(level, x, y, image.width, image.height, texture_storage::pixelFormat(image.channels), GL_UNSIGNED_BYTE,
+               image.pixels.data());
+    }
+    // the source rectangle (sourceX, sourceY, width, height) of image at (x, y), read in
+    // place through the row length, no copy of the region
+    void update(const MipImage& image, int sourceX, int sourceY, int width, int height, int level, int x, int y)
+    {
+        const unsigned char* first = image.pixels.data() + ((size_t)sourceY * image.width + sourceX) * image.channels;
+        update(level, x, y, width, height, texture_storage::pixelFormat(image.channels), GL_UNSIGNED_BYTE, first,
+               image.width);
+    }
+    void bind(GLuint unit) const
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, ID);
+    }
+
+    int width(int level = 0) const { return std::max(textureWidth >> level, 1); }
+    int height(int level = 0) const { return std::max(textureHeight >> level, 1); }
+    int levels() const { return levelCount; }
+    GLenum internalFormat() const { return format; }
+    bool isImmutable() const { return immutable; }
+
+private:
+    int textureWidth = 0;
+    int textureHeight = 0;
+    int levelCount = 0;
+    GLenum format = 0;
+    bool immutable = false;
+
+    bool checkRegion(int level, int x, int y, int w, int h) const
+    {
+        if (level < 0 || level >= levelCount || x < 0 || y < 0 || x + w > width(level) || y + h > height(level))
+        {
+            std::cout << "ERROR::TEXTURE2D::REGION_OUT_OF_RANGE: level " << level << " " << x << "," << y << " "
+                      << w << "x" << h << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+
+#include <gl_ext.h>
+#include <mip_chain.h>
+#include <post_decode.h>
+#include <thread_pool.h>
+
+#include <iostream>
+#include <vector>
+
+// Same-size images stacked as the layers of one GL_TEXTURE_2D_ARRAY. A shader picks the
+// layer per vertex or per instance (shader/texture_array.vs), so quads with different
+// images need neither a bind nor a draw call of their own. Unlike an atlas, layers
+// cannot bleed into each other and keep repeat wrapping and full mip chains.
+// Layers are uploaded as RGBA with mips built on the CPU (mip_chain.h), on `pool`
+// when one is given.
+// ------------------------------------------------------------------------
+class TextureArray
+{
+public:
+    GLuint ID = 0;
+
+    TextureArray(const std::vector<MipImage>& layers, const MipOptions& mipOptions = MipOptions(), ThreadPool* pool = nullptr)
+    {
+        if (layers.empty())
+            return;
+        const int width = layers[0].width, height = layers[0].height;
+        for (const MipImage& layer : layers)
+        {
+            if (layer.width != width || layer.height != height)
+            {
+                std::cout << "ERROR::TEXTURE_ARRAY::LAYER_SIZE_MISMATCH: " << layer.width << "x" << layer.height
+                          << ", expected " << width << "x" << height << std::endl;
+                return;
+            }
+        }
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if ((GLint)layers.size() > maxLayers)
+        {
+            std::cout << "ERROR::TEXTURE_ARRAY::TOO_MANY_LAYERS: " << layers.size() << " > " << maxLayers << std::endl;
+            return;
+        }
+
+        // one mip chain per layer, in parallel when there is a pool
+        std::vector<std::vector<MipImage>> chains(layers.size());
+        auto build = [&](size_t i) {
+            PostDecodeOptions toRgba;
+            toRgba.outputChannels = 4;
+            const MipImage& layer = layers[i];
+            chains[i] = buildMipChain(postDecode(layer.pixels.data(), layer.width, layer.height, layer.channels, toRgba), mipOptions);
+        };
+        if (pool)
+            pool->parallelFor(layers.size(), build);
+        else
+            for (size_t i = 0; i < layers.size(); ++i)
+                build(i);
+
+        layerCount = (int)layers.size();
+        levelCount = (int)chains[0].size();
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        const glext::Functions& f = glext::functions();
+        if (f.textureStorage)
+            f.TexStorage3D(GL_TEXTURE_2D_ARRAY, levelCount, GL_RGBA8, width, height, layerCount);
+        for (int level = 0; level < levelCount; ++level)
+        {
+            const MipImage& size = chains[0][level];
+            if (!f.textureStorage)
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size.width, size.height, layerCount, 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, NULL);
+            for (int layer = 0; layer < layerCount; ++layer)
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, size.width, size.height, 1, GL_RGBA,
+                                GL_UNSIGNED_BYTE, chains[layer][level].pixels.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        layerWidth = width;
+        layerHeight = height;
+    }
+    ~TextureArray()
+    {
+        if (ID)
+            glDeleteTextures(1, &ID);
+    }
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    bool isValid() const { return ID != 0; }
+    void bind(GLuint unit) const
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    }
+    int layers() const { return layerCount; }
+    int levels() const { return levelCount; }
+    int width() const { return layerWidth; }
+    int height() const { return layerHeight; }
+
+private:
+    int layerCount = 0;
+    int levelCount = 0;
+    int layerWidth = 0;
+    int layerHeight = 0;
+};
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <mip_chain.h>
+#include <post_decode.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// Packing many small images into a few large textures, so sprites drawn with
+// different images can share one bind and one draw call.
+// ------------------------------------------------------------------------
+struct AtlasRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+enum class PackHeuristic
+{
+    Skyline,  // bottom-left on a height profile: fast, fine for incremental runtime packing
+    MaxRects  // best short side fit over all free rectangles: denser, slower with many rects
+};
+
+// One page of rectangle packing. insert() can be called at any time (runtime atlases);
+// offline, inserting the rectangles largest first packs noticeably tighter.
+// ------------------------------------------------------------------------
+class RectPacker
+{
+public:
+    RectPacker(int width, int height, PackHeuristic heuristic = PackHeuristic::MaxRects)
+        : width(width), height(height), heuristic(heuristic)
+    {
+        skyline.push_back({0, 0, width});
+        freeRects.push_back({0, 0, width, height});
+    }
+
+    // false when the rectangle does not fit anywhere on the page
+    bool insert(int w, int h, AtlasRect& placed)
+    {
+        bool fits = heuristic == PackHeuristic::Skyline ? insertSkyline(w, h, placed) : insertMaxRects(w, h, placed);
+        if (fits)
+            usedArea += (long long)w * h;
+        return fits;
+    }
+    // packed area / page area
+    double occupancy() const
+    {
+        return (double)usedArea / ((double)width * height);
+    }
+    int pageWidth() const { return width; }
+    int pageHeight() const { return height; }
+
+private:
+    struct Segment
+    {
+        int x, y, width;
+    };
+    int width, height;
+    PackHeuristic heuristic;
+    long long usedArea = 0;
+    std::vector<Segment> skyline;    // left to right, covers the page width
+    std::vector<AtlasRect> freeRects; // MaxRects: maximal free rectangles, may overlap
+
+    // ---- skyline ----
+    // the lowest y a w x h rectangle can sit at with its left edge on segment `index`
+    bool fitSkyline(size_t index, int w, int h, int& y) const
+    {
+        if (skyline[index].x + w > width)
+            return false;
+        y = skyline[index].y;
+        for (int left = w; left > 0; left -= skyline[index].width, ++index)
+        {
+            if (index == skyline.size())
+                return false;
+            y = std::max(y, skyline[index].y);
+            if (y + h > height)
+                return false;
+        }
+        return true;
+    }
+    bool insertSkyline(int w, int h, AtlasRect& placed)
+    {
+        size_t best = skyline.size();
+        int bestTop = height + 1, bestWidth = width + 1;
+        for (size_t i = 0; i < skyline.size(); ++i)
+        {
+            int y;
+            if (fitSkyline(i, w, h, y) && (y + h < bestTop || (y + h == bestTop && skyline[i].width < bestWidth)))
+            {
+                best = i;
+                bestTop = y + h;
+                bestWidth = skyline[i].width;
+                placed = {skyline[i].x, y, w, h};
+            }
+        }
+        if (best == skyline.size())
+            return false;
+        // the new segment covers [x, x + w); the ones it shadows shrink or go away
+        skyline.insert(skyline.begin() + best, {placed.x, placed.y + h, w});
+        for (size_t i = best + 1; i < skyline.size();)
+        {
+            int covered = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+            if (covered <= 0)
+                break;
+            skyline[i].x += covered;
+            skyline[i].width -= covered;
+            if (skyline[i].width > 0)
+                break;
+            skyline.erase(skyline.begin() + i);
+        }
+        for (size_t i = 1; i < skyline.size();)
+        {
+            if (skyline[i - 1].y == skyline[i].y)
+            {
+                skyline[i - 1].width += skyline[i].width;
+                skyline.erase(skyline.begin() + i);
+            }
+            else
+                ++i;
+        }
+        return true;
+    }
+
+    // ---- MaxRects ----
+    bool insertMaxRects(int w, int h, AtlasRect& placed)
+    {
+        int bestShort = -1, bestLong = 0;
+        for (const AtlasRect& free : freeRects)
+        {
+            if (w > free.width || h > free.height)
+                continue;
+            int leftoverX = free.width - w, leftoverY = free.height - h;
+            int shortSide = std::min(leftoverX, leftoverY), longSide = std::max(leftoverX, leftoverY);
+            if (bestShort < 0 || shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+            {
+                bestShort = shortSide;
+                bestLong = longSide;
+                placed = {free.x, free.y, w, h};
+            }
+        }
+        if (bestShort < 0)
+            return false;
+        std::vector<AtlasRect> split;
+        for (size_t i = 0; i < freeRects.size();)
+        {
+            if (splitFreeRect(freeRects[i], placed, split))
+            {
+                freeRects[i] = freeRects.back();
+                freeRects.pop_back();
+            }
+            else
+                ++i;
+        }
+        freeRects.insert(freeRects.end(), split.begin(), split.end());
+        pruneFreeRects();
+        return true;
+    }
+    // the parts of `free` around `used`, when they overlap
+    static bool splitFreeRect(const AtlasRect& free, const AtlasRect& used, std::vector<AtlasRect>& out)
+    {
+        if (used.x >= free.x + free.width || used.x + used.width <= free.x ||
+            used.y >= free.y + free.height || used.y + used.height <= free.y)
+            return false;
+        if (used.y > free.y)
+            out.push_back({free.x, free.y, free.width, used.y - free.y});
+        if (used.y + used.height < free.y + free.height)
+            out.push_back({free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height});
+        if (used.x > free.x)
+            out.push_back({free.x, free.y, used.x - free.x, free.height});
+        if (used.x + used.width < free.x + free.width)
+            out.push_back({used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height});
+        return true;
+    }
+    static bool contains(const AtlasRect& outer, const AtlasRect& inner)
+    {
+        return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width &&
+               inner.y + inner.height <= outer.y + outer.height;
+    }
+    void pruneFreeRects()
+    {
+        for (size_t i = 0; i < freeRects.size(); ++i)
+            for (size_t j = i + 1; j < freeRects.size();)
+            {
+                if (contains(freeRects[i], freeRects[j]))
+                    freeRects.erase(freeRects.begin() + j);
+                else if (contains(freeRects[j], freeRects[i]))
+                {
+                    freeRects.erase(freeRects.begin() + i);
+                    j = i + 1;
+                }
+                else
+                    ++j;
+            }
+    }
+};
+
+struct AtlasOptions
+{
+    int pageSize = 2048;
+    // texels of edge colour around every image, so bilinear filtering and the smaller
+    // mip levels do not pick up the neighbours
+    int padding = 4;
+    // power of two the padded cells start on; a 2^k box filtered level never mixes two
+    // cells while 2^k <= alignment (4 also keeps BC blocks inside one cell)
+    int alignment = 4;
+    PackHeuristic heuristic = PackHeuristic::MaxRects;
+    bool srgb = true;
+};
+
+// where an image ended up; the UVs span exactly the image, GL's bottom-up v included
+struct AtlasEntry
+{
+    int page = -1; // -1: larger than a page, not packed
+    AtlasRect rect;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+};
+
+struct Atlas
+{
+    std::vector<std::vector<MipImage>> pages; // RGBA, each with its mip chain
+    std::vector<AtlasEntry> entries;          // in the order of the input images
+    std::vector<double> occupancy;            // image texels / page texels, per page
+    std::vector<double> cellOccupancy;        // the same with padding and alignment
+    int mipLevels = 1; // levels free of bleeding, see AtlasOptions
+
+    void report() const
+    {
+        size_t packed = 0;
+        for (const AtlasEntry& entry : entries)
+            packed += entry.page >= 0;
+        std::cout << "ATLAS: " << packed << " of " << entries.size() << " images on " << pages.size() << " pages, "
+                  << mipLevels << " mip levels" << std::endl;
+        for (size_t i = 0; i < pages.size(); ++i)
+            std::cout << "ATLAS::PAGE " << i << ": " << pages[i][0].width << "x" << pages[i][0].height << ", "
+                      << occupancy[i] * 100.0 << "% images, " << cellOccupancy[i] * 100.0 << "% with padding" << std::endl;
+    }
+};
+
+// the number of mip levels (base included) whose box filtered texels, and bilinear
+// taps at the image edges, stay inside an image's own padded cell
+inline int atlasMipLevels(int padding, int alignment)
+{
+    int block = 1;
+    while (block * 2 <= alignment && block * 2 <= padding && padding % (block * 2) == 0)
+        block *= 2;
+    int levels = 1;
+    for (; block > 1; block /= 2)
+        ++levels;
+    return levels;
+}
+
+// pack `images` (any channel count, flipped for GL) into pages of options.pageSize
+// ------------------------------------------------------------------------
+inline Atlas buildAtlas(const std::vector<MipImage>& images, const AtlasOptions& options = AtlasOptions())
+{
+    Atlas atlas;
+    atlas.entries.resize(images.size());
+    const int alignment = std::max(options.alignment, 1), cells = options.pageSize / alignment;
+    atlas.mipLevels = atlasMipLevels(options.padding, alignment);
+    auto cellSize = [&](int size) { return (size + 2 * options.padding + alignment - 1) / alignment; };
+
+    // largest first, by the longer side then the area
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const MipImage &ia = images[a], &ib = images[b];
+        int longA = std::max(ia.width, ia.height), longB = std::max(ib.width, ib.height);
+        return longA != longB ? longA > longB : ia.width * ia.height > ib.width * ib.height;
+    });
+
+    // packing in units of `alignment`, which keeps every cell aligned
+    std::vector<RectPacker> packers;
+    std::vector<long long> imageTexels;
+    for (size_t index : order)
+    {
+        const MipImage& image = images[index];
+        const int w = cellSize(image.width), h = cellSize(image.height);
+        AtlasEntry& entry = atlas.entries[index];
+        if (w > cells || h > cells)
+        {
+            std::cout << "ERROR::ATLAS::IMAGE_TOO_LARGE: image " << index << " is " << image.width << "x"
+                      << image.height << std::endl;
+            continue;
+        }
+        AtlasRect cell;
+        size_t page = 0;
+        while (page < packers.size() && !packers[page].insert(w, h, cell))
+            ++page;
+        if (page == packers.size())
+        {
+            packers.emplace_back(cells, cells, options.heuristic);
+            imageTexels.push_back(0);
+            packers.back().insert(w, h, cell);
+        }
+        entry.page = (int)page;
+        entry.rect = {cell.x * alignment + options.padding, cell.y * alignment + options.padding, image.width, image.height};
+        imageTexels[page] += (long long)image.width * image.height;
+    }
+
+    // copy the images in, edge texels repeated over the whole cell
+    const int size = cells * alignment;
+    atlas.pages.resize(packers.size());
+    std::vector<MipImage> bases(packers.size());
+    for (MipImage& base : bases)
+    {
+        base.width = base.height = size;
+        base.channels = 4;
+        base.pixels.assign((size_t)size * size * 4, 0);
+    }
+    PostDecodeOptions toRgba;
+    toRgba.outputChannels = 4;
+    for (size_t index = 0; index < images.size(); ++index)
+    {
+        AtlasEntry& entry = atlas.entries[index];
+        if (entry.page < 0)
+            continue;
+        const MipImage rgba = postDecode(images[index].pixels.data(), images[index].width, images[index].height,
+                                         images[index].channels, toRgba);
+        MipImage& base = bases[entry.page];
+        const AtlasRect& r = entry.rect;
+        const int x0 = r.x - options.padding, y0 = r.y - options.padding;
+        const int x1 = std::min(size, (r.x + r.width + options.padding + alignment - 1) / alignment * alignment);
+        const int y1 = std::min(size, (r.y + r.height + options.padding + alignment - 1) / alignment * alignment);
+        for (int y = y0; y < y1; ++y)
+        {
+            const int sy = std::min(std::max(y - r.y, 0), r.height - 1);
+            for (int x = x0; x < x1; ++x)
+            {
+                const int sx = std::min(std::max(x - r.x, 0), r.width - 1);
+                std::memcpy(&base.pixels[((size_t)y * size + x) * 4], &rgba.pixels[((size_t)sy * r.width + sx) * 4], 4);
+            }
+        }
+        entry.u0 = (float)r.x / size;
+        entry.v0 = (float)r.y / size;
+        entry.u1 = (float)(r.x + r.width) / size;
+        entry.v1 = (float)(r.y + r.height) / size;
+    }
+
+    MipOptions mips;
+    mips.filter = MipFilter::Box; // wider kernels would reach across cells
+    mips.srgb = options.srgb;
+    for (size_t page = 0; page < bases.size(); ++page)
+    {
+        atlas.occupancy.push_back((double)imageTexels[page] / ((double)size * size));
+        atlas.cellOccupancy.push_back(packers[page].occupancy());
+        atlas.pages[page] = buildMipChain(std::move(bases[page]), mips, atlas.mipLevels);
+    }
+    return atlas;
+}
+
+// map the [0, 1] texture coordinates of vertices drawn with one image onto its atlas
+// rectangle. `stride` and `uvOffset` count floats. Repeating (UVs outside [0, 1]) does
+// not survive this, such images have to stay textures of their own
+// ------------------------------------------------------------------------
+inline void rewriteUVs(float* vertices, size_t vertexCount, size_t stride, size_t uvOffset, const AtlasEntry& entry)
+{
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        float* uv = vertices + i * stride + uvOffset;
+        uv[0] = entry.u0 + uv[0] * (entry.u1 - entry.u0);
+        uv[1] = entry.v0 + uv[1] * (entry.v1 - entry.v0);
+    }
+}
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <fnv1a.h>
+#include <mip_streamer.h>
+#include <texture_loader.h>
+
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// What makes two textures the same: the file, how its pixels are converted after
+// decoding and how it is sampled (the parameters live in the texture object, so
+// differently sampled uses of one file are different textures).
+// ------------------------------------------------------------------------
+struct TextureDesc
+{
+    std::string path;
+    bool flipVertically = true;
+    int outputChannels = 4;        // 0 keeps the file's channel count
+    bool premultiplyAlpha = false;
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+    bool preferCooked = true;      // use <cookedDirectory>/<stem>.ctex when it exists
+    bool streamMips = false;       // cooked only: levels come and go with MipStreamer requests
+
+    bool operator==(const TextureDesc& other) const
+    {
+        return path == other.path && flipVertically == other.flipVertically && outputChannels == other.outputChannels &&
+               premultiplyAlpha == other.premultiplyAlpha && wrapS == other.wrapS && wrapT == other.wrapT &&
+               minFilter == other.minFilter && magFilter == other.magFilter && preferCooked == other.preferCooked &&
+               streamMips == other.streamMips;
+    }
+};
+
+struct TextureDescHash
+{
+    size_t operator()(const TextureDesc& desc) const
+    {
+        const uint32_t fields[] = {desc.flipVertically, (uint32_t)desc.outputChannels, desc.premultiplyAlpha,
+                                   desc.wrapS, desc.wrapT, desc.minFilter, desc.magFilter, desc.preferCooked,
+                                   desc.streamMips};
+        return (size_t)fnv1a64((const char*)fields, sizeof(fields), fnv1a64(desc.path));
+    }
+};
+
+class TextureCache;
+
+// A counted reference to a cached texture. Copies share it; while any handle is alive
+// the texture is never evicted. Handles must not outlive their TextureCache.
+// ------------------------------------------------------------------------
+class TextureHandle
+{
+public:
+    TextureHandle() = default;
+    TextureHandle(const TextureHandle& other) : cache(other.cache), entry(other.entry) { retain(); }
+    TextureHandle(TextureHandle&& other) noexcept : cache(other.cache), entry(other.entry)
+    {
+        other.cache = nullptr;
+        other.entry = nullptr;
+    }
+    TextureHandle& operator=(TextureHandle other) noexcept
+    {
+        std::swap(cache, other.cache);
+        std::swap(entry, other.entry);
+        return *this;
+    }
+    ~TextureHandle() { release(); }
+
+    inline GLuint id() const;
+    explicit operator bool() const { return entry != nullptr; }
+
+private:
+    friend class TextureCache;
+    struct Entry;
+    TextureCache* cache = nullptr;
+    Entry* entry = nullptr;
+
+    TextureHandle(TextureCache* cache, Entry* entry) : cache(cache), entry(entry) { retain(); }
+    inline void retain();
+    inline void release();
+};
+
+struct TextureHandle::Entry
+{
+    TextureDesc desc;
+    GLuint texture = 0;
+    size_t bytes = 0;
+    bool loaded = false; // bytes is known and the loader is done with it
+    bool streamed = false; // owned by the MipStreamer, which accounts for its bytes
+    int refs = 0;
+    bool inUnused = false;
+    std::list<Entry*>::iterator unusedPosition;
+};
+
+// Loads each distinct TextureDesc once (through a TextureLoader, so decoding stays on
+// the workers) and hands out TextureHandles. A texture no handle refers to stays
+// resident, so loading the same scene again is a hit, until the GPU bytes of all
+// textures exceed `budget`; then the least recently released ones are deleted first.
+// Textures still loading and textures in use are never evicted, so the budget can be
+// exceeded by what is actually needed. Textures with streamed mips count against the
+// MipStreamer's budget instead. GL thread only.
+// ------------------------------------------------------------------------
+class TextureCache
+{
+public:
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+    size_t evictedBytes = 0;
+    size_t budget;
+    std::string cookedDirectory = "cooked";
+
+    explicit TextureCache(size_t budget = size_t(256) << 20)
+        : budget(budget)
+    {
+        // loadCooked() reports before acquire() knows the texture name, that upload
+        // belongs to the entry being created
+        textureLoader.onUploaded = [this](GLuint texture, size_t bytes) {
+            auto it = byTexture.find(texture);
+            Entry* entry = it != byTexture.end() ? it->second : creating;
+            if (!entry || entry->loaded)
+                return;
+            entry->bytes = bytes;
+            entry->loaded = true;
+            residentBytes += bytes;
+        };
+        // a texture that failed to load keeps its 1x1 placeholder and can be evicted like any other
+        textureLoader.onFailed = [this](GLuint texture) {
+            auto it = byTexture.find(texture);
+            if (it == byTexture.end() || it->second->loaded)
+                return;
+            it->second->bytes = 4;
+            it->second->loaded = true;
+            residentBytes += 4;
+        };
+    }
+    ~TextureCache()
+    {
+        for (auto& entry : entries)
+            if (!entry.second->streamed)
+                glDeleteTextures(1, &entry.second->texture);
+    }
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // the cached texture, or a new one that shows a placeholder until it has loaded
+    // ------------------------------------------------------------------------
+    TextureHandle acquire(const TextureDesc& desc)
+    {
+        auto it = entries.find(desc);
+        if (it != entries.end())
+        {
+            ++hits;
+            return TextureHandle(this, it->second.get());
+        }
+        ++misses;
+        std::unique_ptr<TextureHandle::Entry> entry(new TextureHandle::Entry());
+        entry->desc = desc;
+        creating = entry.get();
+        entry->texture = create(desc, entry->streamed);
+        creating = nullptr;
+        entry->loaded = entry->loaded || entry->streamed;
+        TextureHandle::Entry* raw = entry.get();
+        byTexture[raw->texture] = raw;
+        entries.emplace(desc, std::move(entry));
+        return TextureHandle(this, raw);
+    }
+    // path with the default TextureDesc
+    TextureHandle acquire(const std::string& path)
+    {
+        TextureDesc desc;
+        desc.path = path;
+        return acquire(desc);
+    }
+    // once per frame, after the frame's MipStreamer requests: uploads, then eviction
+    // down to the budget
+    // ------------------------------------------------------------------------
+    void update()
+    {
+        textureLoader.update();
+        mipStreamer.update();
+        trim(budget);
+    }
+    // evict unused textures, least recently released first, until `bytes` or less are resident
+    void trim(size_t bytes)
+    {
+        for (auto it = unused.begin(); it != unused.end() && residentBytes > bytes;)
+        {
+            TextureHandle::Entry* entry = *it;
+            if (!entry->loaded)
+            {
+                ++it;
+                continue;
+            }
+            it = unused.erase(it);
+            evict(entry);
+        }
+    }
+    // every unused texture, e.g. after a level has been unloaded
+    void purge() { trim(0); }
+
+    size_t resident() const { return residentBytes; }
+    size_t textureCount() const { return entries.size(); }
+    size_t unusedCount() const { return unused.size(); }
+    TextureLoader& loader() { return textureLoader; }
+    MipStreamer& streamer() { return mipStreamer; }
+
+    void report() const
+    {
+        std::cout << "TEXTURE::CACHE: " << entries.size() << " textures (" << unused.size() << " unused), "
+                  << residentBytes / 1024 << " of " << budget / 1024 << " KiB, " << hits << " hits, " << misses
+                  << " misses, " << evictions << " evictions (" << evictedBytes / 1024 << " KiB)" << std::endl;
+    }
+
+private:
+    friend class TextureHandle;
+    using Entry = TextureHandle::Entry;
+
+    TextureLoader textureLoader;
+    MipStreamer mipStreamer;
+    std::unordered_map<TextureDesc, std::unique_ptr<Entry>, TextureDescHash> entries;
+    std::unordered_map<GLuint, Entry*> byTexture;
+    std::list<Entry*> unused; // no handles left, front = released longest ago
+    size_t residentBytes = 0;
+    Entry* creating = nullptr; // during create(), for uploads that happen right away
+
+    GLuint create(const TextureDesc& desc, bool& streamed)
+    {
+        GLuint texture = 0;
+        streamed = false;
+        if (desc.preferCooked && !cookedDirectory.empty())
+        {
+            // texcook output is flipped, with straight alpha
+            std::filesystem::path cooked = std::filesystem::path(cookedDirectory) /
+                                           (std::filesystem::path(desc.path).stem().string() + ".ctex");
+            if (desc.flipVertically && !desc.premultiplyAlpha && desc.streamMips)
+                streamed = (texture = mipStreamer.add(cooked.string())) != 0;
+            else if (desc.flipVertically && !desc.premultiplyAlpha)
+                texture = textureLoader.loadCooked(cooked.string());
+        }
+        if (!texture)
+        {
+            PostDecodeOptions post = textureLoader.postDecodeOptions;
+            post.flipVertically = desc.flipVertically;
+            post.outputChannels = desc.outputChannels;
+            post.premultiplyAlpha = desc.premultiplyAlpha;
+            texture = textureLoader.load(desc.path, post);
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, desc.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, desc.wrapT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, desc.magFilter);
+        return texture;
+    }
+    void evict(Entry* entry)
+    {
+        ++evictions;
+        evictedBytes += entry->bytes;
+        residentBytes -= entry->bytes;
+        if (entry->streamed)
+            mipStreamer.remove(entry->texture);
+        else
+            glDeleteTextures(1, &entry->texture);
+        byTexture.erase(entry->texture);
+        TextureDesc desc = entry->desc; // the key must outlive the erase, it destroys entry
+        entries.erase(desc);
+    }
+    void retain(Entry* entry)
+    {
+        if (entry->refs++ == 0 && entry->inUnused)
+        {
+            unused.erase(entry->unusedPosition);
+            entry->inUnused = false;
+        }
+    }
+    void release(Entry* entry)
+    {
+        if (--entry->refs > 0)
+            return;
+        entry->unusedPosition = unused.insert(unused.end(), entry);
+        entry->inUnused = true;
+    }
+};
+
+inline GLuint TextureHandle::id() const
+{
+    return entry ? entry->texture : 0;
+}
+inline void TextureHandle::retain()
+{
+    if (entry)
+        cache->retain(entry);
+}
+inline void TextureHandle::release()
+{
+    if (entry)
+        cache->release(entry);
+    cache = nullptr;
+    entry = nullptr;
+}
+
+#endif
@@ -0,0 +1,404 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+
+#include <block_compression.h>
+#include <cooked_texture.h>
+#include <gl_ext.h>
+#include <mapped_file.h>
+#include <mip_chain.h>
+#include <post_decode.h>
+#include <texture_2d.h>
+#include <thread_pool.h>
+// main.cpp includes it first with STB_IMAGE_IMPLEMENTATION, which must not be expanded twice
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include "stb_image.h"
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Asynchronous texture loading. load() returns a texture name at once, holding a 1x1
+// placeholder; the file is decoded on a worker thread (stbi_load_from_memory on the
+// mapped file), the GL thread maps a pixel unpack buffer for it, a worker copies the
+// pixels in, and update() finally unmaps it and uploads from the buffer. Flipping and
+// format conversion (postDecodeOptions) and the mip chain (mipOptions) are done on the
+// worker as well, not by stb_image's flip pass and glGenerateMipmap.
+// Call update() once per frame: mapping and uploading together stop after
+// `uploadBudget` bytes, so hundreds of textures arrive over several frames instead
+// of freezing the window.
+// ------------------------------------------------------------------------
+class TextureLoader
+{
+public:
+    int loaded = 0;
+    int failed = 0;
+    int cookedLoaded = 0;
+    int decompressedOnLoad = 0; // compressed files the driver could not take
+    size_t uploadedBytes = 0;
+    // set both before the first load(), workers read them. The default uploads RGBA
+    // (3 channel rows are a slow path for many drivers) with sRGB aware box filtered mips
+    PostDecodeOptions postDecodeOptions;
+    MipOptions mipOptions;
+    // GL thread, when a texture has its final images: the bytes it now holds on the GPU
+    std::function<void(GLuint texture, size_t bytes)> onUploaded;
+    // GL thread, when a load() could not be decoded; the texture keeps its placeholder
+    std::function<void(GLuint texture)> onFailed;
+
+    // worker time summed over all textures, per stage
+    struct Timings
+    {
+        double decodeMs = 0.0;     // stbi_load_from_memory
+        double postDecodeMs = 0.0; // flip + expand + swizzle + premultiply, one pass
+        double mipsMs = 0.0;
+        double copyMs = 0.0;       // into the mapped unpack buffer
+    };
+
+    explicit TextureLoader(size_t uploadBudget = 8 << 20, unsigned int threads = 0)
+        : uploadBudget(uploadBudget), pool(new ThreadPool(threads))
+    {
+        postDecodeOptions.outputChannels = 4;
+        mipOptions.srgb = true; // colour textures hold sRGB values
+    }
+    ~TextureLoader()
+    {
+        // workers first, they may still be writing into mapped buffers
+        pool.reset();
+        for (const std::shared_ptr<Request>& request : requests)
+        {
+            if (request->pbo)
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, request->pbo);
+                if (request->mapped)
+                    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                glDeleteBuffers(1, &request->pbo);
+            }
+        }
+    }
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // the texture is usable right away; set its wrap and filter parameters as usual,
+    // the upload only replaces the images
+    // ------------------------------------------------------------------------
+    GLuint load(const std::string& path, bool flipVertically = true)
+    {
+        PostDecodeOptions post = postDecodeOptions;
+        post.flipVertically = flipVertically;
+        return load(path, post);
+    }
+    // the same with this texture's own post-decode options instead of postDecodeOptions
+    GLuint load(const std::string& path, const PostDecodeOptions& post)
+    {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const unsigned char placeholder[4] = {128, 128, 128, 255};
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+        std::shared_ptr<Request> request(new Request());
+        request->texture = texture;
+        request->path = path;
+        request->post = post;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(request);
+        }
+        pool->submit([this, request] { decode(*request); });
+        return texture;
+    }
+    // a texcook .ctex file: mapped and uploaded level by level right here, there is
+    // nothing to decode and no glGenerateMipmap. Block compressed files go to the GL as
+    // they are when the driver has the format, else they are decompressed to RGBA
+    // first. 0 when the file is missing or invalid
+    // ------------------------------------------------------------------------
+    GLuint loadCooked(const std::string& path)
+    {
+        CookedTexture cooked(path);
+        if (!cooked.isOpen())
+            return 0;
+        GLuint texture;
+        glGenTextures(1, &texture);
+        size_t bytes = uploadCooked(cooked, texture);
+        ++loaded;
+        ++cookedLoaded;
+        if (onUploaded)
+            onUploaded(texture, bytes);
+        return texture;
+    }
+    // GL thread, once per frame
+    // ------------------------------------------------------------------------
+    void update()
+    {
+        std::vector<std::shared_ptr<Request>> copied, decoded;
+        std::vector<GLuint> failedTextures;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = requests.begin(); it != requests.end();)
+            {
+                Request& request = **it;
+                if (request.state == State::Failed)
+                {
+                    std::cout << "ERROR::TEXTURE_LOADER::LOAD_FAILED: " << request.path << std::endl;
+                    ++failed;
+                    failedTextures.push_back(request.texture);
+                    it = requests.erase(it);
+                    continue;
+                }
+                if (request.state == State::Copied)
+                    copied.push_back(*it);
+                else if (request.state == State::Decoded)
+                    decoded.push_back(*it);
+                ++it;
+            }
+        }
+        if (onFailed)
+            for (GLuint texture : failedTextures)
+                onFailed(texture);
+        size_t spent = 0;
+        // finished copies first, their buffers are already paid for; at least one upload
+        // per frame even when a single texture is larger than the budget
+        for (const std::shared_ptr<Request>& request : copied)
+        {
+            if (spent > 0 && spent + request->bytes() > uploadBudget)
+                break;
+            upload(*request);
+            spent += request->bytes();
+        }
+        for (const std::shared_ptr<Request>& request : decoded)
+        {
+            if (spent > 0 && spent + request->bytes() > uploadBudget)
+                break;
+            if (!mapBuffer(*request))
+                continue;
+            spent += request->bytes();
+            pool->submit([this, request] { copy(*request); });
+        }
+        uploadedBytes += spent;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = requests.begin(); it != requests.end();)
+            it = (*it)->state == State::Done ? requests.erase(it) : it + 1;
+    }
+    // textures still showing their placeholder
+    size_t pending() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests.size();
+    }
+    Timings timings() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stageTimes;
+    }
+    // the GL format for block compressed data, 0 when the driver lacks it
+    static GLenum compressedFormatFor(BlockFormat format)
+    {
+        const glext::Functions& f = glext::functions();
+        switch (format)
+        {
+        case BlockFormat::BC1: return f.textureCompressionS3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+        case BlockFormat::BC3: return f.textureCompressionS3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+        case BlockFormat::BC7: return f.textureCompressionBptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+        default: return 0;
+        }
+    }
+
+private:
+    enum class State
+    {
+        Decoding, // worker: read and decode the file
+        Decoded,  // GL thread: waiting for a mapped unpack buffer
+        Copying,  // worker: pixels -> mapped buffer
+        Copied,   // GL thread: unmap and upload
+        Done,
+        Failed
+    };
+    struct Request
+    {
+        GLuint texture = 0;
+        std::string path;
+        PostDecodeOptions post;
+        State state = State::Decoding;
+        std::vector<MipImage> levels;
+        size_t byteCount = 0;
+        GLuint pbo = 0;
+        void* mapped = nullptr;
+
+        size_t bytes() const { return byteCount; }
+    };
+
+    size_t uploadBudget;
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<Request>> requests;
+    Timings stageTimes;
+    std::unique_ptr<ThreadPool> pool;
+
+    static double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void setState(Request& request, State state)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request.state = state;
+    }
+    // worker
+    void decode(Request& request)
+    {
+        auto start = std::chrono::steady_clock::now();
+        MappedFile file(request.path);
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = nullptr;
+        if (file.isOpen())
+        {
+            // the flip is part of postDecode; stb's own flip would be one more pass
+            stbi_set_flip_vertically_on_load_thread(0);
+            pixels = stbi_load_from_memory((const stbi_uc*)file.data(), (int)file.size(), &width, &height, &channels, 0);
+        }
+        if (!pixels)
+        {
+            setState(request, State::Failed);
+            return;
+        }
+        double decodeMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        const PostDecodeOptions& post = request.post;
+        MipImage base = postDecode(pixels, width, height, channels, post);
+        stbi_image_free(pixels);
+        double postDecodeMs = millisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        MipOptions mips = mipOptions;
+        mips.premultiplyAlpha = mips.premultiplyAlpha && !post.premultiplyAlpha; // already done, and kept
+        request.levels = buildMipChain(std::move(base), mips);
+        for (const MipImage& level : request.levels)
+            request.byteCount += level.pixels.size();
+        double mipsMs = millisecondsSince(start);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stageTimes.decodeMs += decodeMs;
+        stageTimes.postDecodeMs += postDecodeMs;
+        stageTimes.mipsMs += mipsMs;
+        request.state = State::Decoded;
+    }
+    // worker
+    void copy(Request& request)
+    {
+        // levels back to back, largest first
+        auto start = std::chrono::steady_clock::now();
+        unsigned char* at = (unsigned char*)request.mapped;
+        for (MipImage& level : request.levels)
+        {
+            std::memcpy(at, level.pixels.data(), level.pixels.size());
+            at += level.pixels.size();
+            std::vector<unsigned char>().swap(level.pixels);
+        }
+        double copyMs = millisecondsSince(start);
+        std::lock_guard<std::mutex> lock(mutex);
+        stageTimes.copyMs += copyMs;
+        request.state = State::Copied;
+    }
+    // GL thread
+    bool mapBuffer(Request& request)
+    {
+        glGenBuffers(1, &request.pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, request.pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, request.bytes(), NULL, GL_STREAM_DRAW);
+        request.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, request.bytes(),
+                                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!request.mapped)
+        {
+            // no mapping this frame, the buffer is tried again on the next one
+            glDeleteBuffers(1, &request.pbo);
+            request.pbo = 0;
+            return false;
+        }
+        setState(request, State::Copying);
+        return true;
+    }
+    // returns the bytes the texture holds
+    size_t uploadCooked(const CookedTexture& cooked, GLuint texture)
+    {
+        GLenum format = texture_storage::pixelFormat(cooked.channels());
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const BlockFormat blocks = cooked.format();
+        GLenum compressedFormat = compressedFormatFor(blocks);
+        if (blocks != BlockFormat::None && !compressedFormat)
+            ++decompressedOnLoad;
+        // all levels allocated at once, immutable when the driver has texture storage
+        const bool decompress = blocks != BlockFormat::None && !compressedFormat;
+        const bool alpha = cooked.channels() == 4 || cooked.channels() == 2;
+        GLenum internalFormat = compressedFormat ? compressedFormat
+                              : decompress ? (alpha ? GL_RGBA8 : GL_RGB8)
+                              : texture_storage::sizedFormat(cooked.channels());
+        texture_storage::allocate((int)cooked.levelCount(), internalFormat, cooked.width(), cooked.height());
+        size_t bytes = 0;
+        for (size_t i = 0; i < cooked.levelCount(); ++i)
+        {
+            const CookedTexture::Level& level = cooked.level(i);
+            // decompressed levels are stored as RGBA, the others as they are in the file
+            bytes += decompress ? (size_t)level.width * level.height * 4 : level.size;
+            if (blocks == BlockFormat::None)
+            {
+                texture_storage::UnpackLayout layout(level.width, 0, cooked.channels(), level.data);
+                glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, format, GL_UNSIGNED_BYTE, level.data);
+            }
+            else if (compressedFormat)
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, compressedFormat, (GLsizei)level.size, level.data);
+            else
+            {
+                MipImage rgba = decompressImage(level.data, level.width, level.height, blocks);
+                glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.pixels.data());
+            }
+            uploadedBytes += level.size;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)cooked.levelCount() - 1);
+        return bytes;
+    }
+    // GL thread
+    void upload(Request& request)
+    {
+        const int channels = request.levels[0].channels;
+        GLenum format = texture_storage::pixelFormat(channels);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, request.pbo);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        request.mapped = nullptr;
+        // replaces the placeholder with immutable storage for every level when the driver
+        // has it; the wrap and filter parameters set meanwhile stay
+        glBindTexture(GL_TEXTURE_2D, request.texture);
+        texture_storage::allocate((int)request.levels.size(), texture_storage::sizedFormat(channels),
+                                  request.levels[0].width, request.levels[0].height);
+        size_t offset = 0;
+        for (size_t i = 0; i < request.levels.size(); ++i)
+        {
+            const MipImage& level = request.levels[i];
+            // rows of 3 channel images are not 4 byte aligned
+            texture_storage::UnpackLayout layout(level.width, 0, channels, (void*)offset);
+            glTexSubImage2D(GL_TEXTURE_2D, (GLint)i, 0, 0, level.width, level.height, format, GL_UNSIGNED_BYTE, (void*)offset);
+            offset += (size_t)level.width * level.height * level.channels;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)request.levels.size() - 1);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &request.pbo);
+        request.pbo = 0;
+        request.levels.clear();
+        ++loaded;
+        if (onUploaded)
+            onUploaded(request.texture, request.bytes());
+        setState(request, State::Done);
+    }
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads taking jobs from one FIFO queue. Jobs must not touch
+// GL: the context belongs to the main thread. The destructor runs the jobs that are
+// still queued and joins the workers.
+// ------------------------------------------------------------------------
+class ThreadPool
+{
+public:
+    // 0 threads: one less than the hardware threads, leaving a core to the GL thread
+    explicit ThreadPool(unsigned int threads = 0)
+    {
+        if (threads == 0)
+        {
+            // hardware_concurrency() may be 0 when the runtime cannot tell
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            threads = hardware > 1 ? hardware - 1 : 1;
+        }
+        for (unsigned int i = 0; i < threads; ++i)
+            workers.emplace_back([this] { run(); });
+    }
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+    // run `count` calls of job(i) spread over the workers and the calling thread, return when all are done
+    // ------------------------------------------------------------------------
+    void parallelFor(size_t count, const std::function<void(size_t)>& job)
+    {
+        std::mutex doneMutex;
+        std::condition_variable doneSignal;
+        size_t remaining = count;
+        auto finishOne = [&] {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0)
+                doneSignal.notify_one();
+        };
+        // the caller takes the last index itself instead of only waiting
+        for (size_t i = 0; i + 1 < count; ++i)
+            submit([&, i] { job(i); finishOne(); });
+        if (count > 0)
+        {
+            job(count - 1);
+            finishOne();
+        }
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneSignal.wait(lock, [&] { return remaining == 0; });
+    }
+    size_t size() const
+    {
+        return workers.size();
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run()
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return; // stopping and drained
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef UNIFORM_BLOCK_H
+#define UNIFORM_BLOCK_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// std140 uniform blocks declared once in C++.
+//
+//   #define FRAME_UNIFORMS(FIELD) FIELD(Mat4, transform) FIELD(Vec4, tint) FIELD(FloatArray<4>, weights)
+//   STD140_BLOCK(FrameUniforms, FRAME_UNIFORMS)
+//
+// declares struct FrameUniforms, checks at compile time that every member sits at
+// its std140 offset, and FrameUniforms::glsl("Frame") returns the matching
+// "layout(std140) uniform Frame { ... };" declaration. A member the check rejects
+// lies too early (std140::Pad moves it to its offset) or too late: std140 puts a
+// float right after a vec3, at byte 12 of its slot, where Vec3's 16 byte sizeof
+// cannot, so declare that vec3 as std140::PackedVec3 or reorder the fields.
+namespace std140
+{
+constexpr size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// member types: align/size are the std140 base alignment and size, glsl the type name
+struct alignas(4) Float { float value = 0.0f; static constexpr size_t align = 4, size = 4; static constexpr const char* glsl = "float";
+    Float& operator=(float v) { value = v; return *this; } };
+struct alignas(4) Int { int value = 0; static constexpr size_t align = 4, size = 4; static constexpr const char* glsl = "int";
+    Int& operator=(int v) { value = v; return *this; } };
+struct alignas(4) UInt { unsigned int value = 0; static constexpr size_t align = 4, size = 4; static constexpr const char* glsl = "uint";
+    UInt& operator=(unsigned int v) { value = v; return *this; } };
+// GLSL bools are 4 bytes in a block
+struct alignas(4) Bool { int value = 0; static constexpr size_t align = 4, size = 4; static constexpr const char* glsl = "bool";
+    Bool& operator=(bool v) { value = v ? 1 : 0; return *this; } };
+struct alignas(8) Vec2 { float value[2] = {}; static constexpr size_t align = 8, size = 8; static constexpr const char* glsl = "vec2"; };
+// sizeof is 16 in C++ but 12 in std140, the layout check catches what would differ
+struct alignas(16) Vec3 { float value[3] = {}; static constexpr size_t align = 16, size = 12; static constexpr const char* glsl = "vec3"; };
+// a vec3 in 12 bytes, for a scalar that shares its 16 byte slot; it has no C++
+// alignment of its own, so the layout check makes sure it still starts on 16 bytes
+struct alignas(4) PackedVec3 { float value[3] = {}; static constexpr size_t align = 16, size = 12; static constexpr const char* glsl = "vec3"; };
+struct alignas(16) Vec4 { float value[4] = {}; static constexpr size_t align = 16, size = 16; static constexpr const char* glsl = "vec4"; };
+// column major, every column padded to a vec4
+struct alignas(16) Mat3 { float value[3][4] = {}; static constexpr size_t align = 16, size = 48; static constexpr const char* glsl = "mat3"; };
+struct alignas(16) Mat4 { float value[16] = {}; static constexpr size_t align = 16, size = 64; static constexpr const char* glsl = "mat4"; };
+
+// explicit padding of N 4 byte words, not declared in the GLSL block
+template <size_t N>
+struct alignas(4) Pad { unsigned int words[N] = {}; static constexpr size_t align = 4, size = 4 * N; static constexpr const char* glsl = nullptr; };
+
+// arrays: every element starts on a 16 byte boundary
+template <typename T, size_t N>
+struct alignas(16) Array
+{
+    struct alignas(16) Element { T value; };
+    Element elements[N];
+    static constexpr size_t align = 16, size = 16 * ((T::size + 15) / 16) * N, count = N;
+    static constexpr const char* glsl = T::glsl;
+    T& operator[](size_t i) { return elements[i].value; }
+    const T& operator[](size_t i) const { return elements[i].value; }
+};
+
+// comma free names for use inside FIELD(type, name)
+template <size_t N> using FloatArray = Array<Float, N>;
+template <size_t N> using IntArray = Array<Int, N>;
+template <size_t N> using Vec2Array = Array<Vec2, N>;
+template <size_t N> using Vec3Array = Array<Vec3, N>;
+template <size_t N> using Vec4Array = Array<Vec4, N>;
+template <size_t N> using Mat4Array = Array<Mat4, N>;
+
+template <typename T>
+struct ArraySuffix { static std::string get() { return ""; } };
+template <typename T, size_t N>
+struct ArraySuffix<Array<T, N>> { static std::string get() { return "[" + std::to_string(N) + "]"; } };
+
+// index of the first member whose C++ offset differs from std140, -1 when all match
+template <size_t N>
+constexpr int firstMismatch(const size_t (&aligns)[N], const size_t (&sizes)[N], const size_t (&offsets)[N])
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        offset = alignUp(offset, aligns[i]);
+        if (offsets[i] != offset)
+            return (int)i;
+        offset += sizes[i];
+    }
+    return -1;
+}
+} // namespace std140
+
+#define STD140_DECLARE_FIELD(type, name) std140::type name;
+#define STD140_FIELD_ALIGN(type, name) std140::type::align,
+#define STD140_FIELD_SIZE(type, name) std140::type::size,
+#define STD140_FIELD_OFFSET(type, name) offsetof(Self, name),
+#define STD140_FIELD_GLSL(type, name) \
+    if (std140::type::glsl) text += std::string("    ") + std140::type::glsl + " " + #name + std140::ArraySuffix<std140::type>::get() + ";\n";
+
+#define STD140_BLOCK(Name, FIELDS)                                                          \
+    struct Name                                                                             \
+    {                                                                                       \
+        typedef Name Self;                                                                  \
+        FIELDS(STD140_DECLARE_FIELD)                                                        \
+        static constexpr int std140Mismatch()                                               \
+        {                                                                                   \
+            constexpr size_t aligns[] = {FIELDS(STD140_FIELD_ALIGN)};                       \
+            constexpr size_t sizes[] = {FIELDS(STD140_FIELD_SIZE)};                         \
+            constexpr size_t offsets[] = {FIELDS(STD140_FIELD_OFFSET)};                     \
+            return std140::firstMismatch(aligns, sizes, offsets);                           \
+        }                                                                                   \
+        static std::string glsl(const std::string& blockName, const std::string& instanceName = "") \
+        {                                                                                   \
+            std::string text = "layout(std140) uniform " + blockName + "\n{\n";            \
+            FIELDS(STD140_FIELD_GLSL)                                                       \
+            return text + "}" + (instanceName.empty() ? "" : " " + instanceName) + ";\n";   \
+        }                                                                                   \
+    };                                                                                      \
+    static_assert(Name::std140Mismatch() < 0,                                               \
+                  #Name ": a member is not at its std140 offset; add std140::Pad before it, or reorder / use std140::PackedVec3 when it follows a vec3")
+
+// binding point of a named block in a program; do it once after linking (and after a hot reload)
+inline void bindUniformBlock(GLuint program, const char* blockName, GLuint bindingPoint)
+{
+    GLuint index = glGetUniformBlockIndex(program, blockName);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, bindingPoint);
+}
+
+// One uniform buffer holding `count` instances of a std140 block, each at an offset
+// that satisfies GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. Fill the CPU copy through
+// operator[], upload() sends everything in a single buffer update, bind(i) selects
+// instance i for the next draws with glBindBufferRange.
+// ------------------------------------------------------------------------
+template <typename T>
+class UniformBlock
+{
+public:
+    UniformBlock(GLuint bindingPoint, size_t count = 1)
+        : bindingPoint(bindingPoint), count(count)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        stride = std140::alignUp(sizeof(T), (size_t)alignment);
+        staging.resize(stride * count);
+        for (size_t i = 0; i < count; ++i)
+            new (staging.data() + i * stride) T();
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        bind(0);
+    }
+    ~UniformBlock()
+    {
+        glDeleteBuffers(1, &buffer);
+    }
+    UniformBlock(const UniformBlock&) = delete;
+    UniformBlock& operator=(const UniformBlock&) = delete;
+
+    T& operator[](size_t i) { return *reinterpret_cast<T*>(staging.data() + i * stride); }
+    const T& operator[](size_t i) const { return *reinterpret_cast<const T*>(staging.data() + i * stride); }
+
+    // orphan the old storage so the driver does not wait for draws still reading it
+    void upload()
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, staging.size(), staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    void bind(size_t i) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, buffer, (GLintptr)(i * stride), (GLsizeiptr)sizeof(T));
+    }
+    size_t size() const { return count; }
+    size_t byteStride() const { return stride; }
+    GLuint id() const { return buffer; }
+
+private:
+    GLuint buffer = 0;
+    GLuint bindingPoint;
+    size_t count;
+    size_t stride = 0;
+    std::vector<unsigned char> staging;
+};
+
+#endif
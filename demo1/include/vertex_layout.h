@@ -0,0 +1,159 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Interleaved vertex formats declared once in C++, the same way as uniform_block.h.
+//
+//   #define TEXTURED_VERTEX(ATTRIBUTE) ATTRIBUTE(0, Vec3, aPos) ATTRIBUTE(1, Unorm8x4, aColor) ATTRIBUTE(2, Vec2, aTexCoord)
+//   VERTEX_LAYOUT(TexturedVertex, TEXTURED_VERTEX)
+//
+// declares struct TexturedVertex with one member per attribute, checks at compile
+// time that the members follow each other without padding and on 4 byte boundaries
+// (what the GL fetches fastest; a member the compiler pads around fails to compile),
+// TexturedVertex::setupAttributes() replaces the glVertexAttribPointer /
+// glEnableVertexAttribArray calls for the bound VAO and buffer, and
+// TexturedVertex::glsl() returns the matching "layout (location = n) in ..." lines.
+namespace vertex_format
+{
+// attribute types: storage, component count, GL type, normalization and the GLSL input
+// type. Every one is a multiple of 4 bytes
+struct Float { float value[1]; static constexpr GLint components = 1; static constexpr GLenum glType = GL_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "float"; };
+struct Vec2 { float value[2]; static constexpr GLint components = 2; static constexpr GLenum glType = GL_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec2"; };
+struct Vec3 { float value[3]; static constexpr GLint components = 3; static constexpr GLenum glType = GL_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec3"; };
+struct Vec4 { float value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec4"; };
+// half floats (IEEE binary16 bits)
+struct Half2 { uint16_t value[2]; static constexpr GLint components = 2; static constexpr GLenum glType = GL_HALF_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec2"; };
+struct Half4 { uint16_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_HALF_FLOAT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec4"; };
+// normalized integers: [0, 1] for unsigned, [-1, 1] for signed
+struct Unorm8x4 { uint8_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_UNSIGNED_BYTE;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+struct Snorm8x4 { int8_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_BYTE;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+struct Unorm16x2 { uint16_t value[2]; static constexpr GLint components = 2; static constexpr GLenum glType = GL_UNSIGNED_SHORT;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec2"; };
+struct Snorm16x2 { int16_t value[2]; static constexpr GLint components = 2; static constexpr GLenum glType = GL_SHORT;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec2"; };
+struct Unorm16x4 { uint16_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_UNSIGNED_SHORT;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+struct Snorm16x4 { int16_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_SHORT;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+// plain 16 bit integers converted to float as they are, e.g. quantized positions with the
+// 1 / 32767 folded into a scale: GL 3.3 and 4.2 disagree on how signed normalized
+// values map to [-1, 1], integers are exact everywhere
+struct Int16x4 { int16_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_SHORT;
+    static constexpr bool normalized = false, integer = false; static constexpr const char* glsl = "vec4"; };
+// x in bits 0-9, y 10-19, z 20-29, w 30-31, normalized
+struct Unorm10_10_10_2 { uint32_t value; static constexpr GLint components = 4; static constexpr GLenum glType = GL_UNSIGNED_INT_2_10_10_10_REV;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+struct Snorm10_10_10_2 { uint32_t value; static constexpr GLint components = 4; static constexpr GLenum glType = GL_INT_2_10_10_10_REV;
+    static constexpr bool normalized = true, integer = false; static constexpr const char* glsl = "vec4"; };
+// integer attributes (glVertexAttribIPointer), e.g. texture array layers or bone indices
+struct UInt { uint32_t value; static constexpr GLint components = 1; static constexpr GLenum glType = GL_UNSIGNED_INT;
+    static constexpr bool normalized = false, integer = true; static constexpr const char* glsl = "uint"; };
+struct UByte4 { uint8_t value[4]; static constexpr GLint components = 4; static constexpr GLenum glType = GL_UNSIGNED_BYTE;
+    static constexpr bool normalized = false, integer = true; static constexpr const char* glsl = "uvec4"; };
+
+struct Attribute
+{
+    GLuint location;
+    GLint components;
+    GLenum glType;
+    bool normalized;
+    bool integer;
+    size_t offset;
+    size_t size;
+    const char* glsl;
+    const char* name;
+};
+template <typename T>
+constexpr Attribute attribute(GLuint location, size_t offset, const char* name)
+{
+    return Attribute{location, T::components, T::glType, T::normalized, T::integer, offset, sizeof(T), T::glsl, name};
+}
+
+// index of the first attribute that does not directly follow the previous one or is not
+// on a 4 byte boundary, -1 when all are packed
+template <size_t N>
+constexpr int firstGap(const std::array<Attribute, N>& attributes)
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (attributes[i].offset != offset || offset % 4 != 0)
+            return (int)i;
+        offset += attributes[i].size;
+    }
+    return -1;
+}
+template <size_t N>
+constexpr size_t packedSize(const std::array<Attribute, N>& attributes)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < N; ++i)
+        size += attributes[i].size;
+    return size;
+}
+
+// one attribute of the bound VAO from the bound GL_ARRAY_BUFFER
+inline void enable(const Attribute& attribute, GLsizei stride, size_t baseOffset, GLuint divisor)
+{
+    const void* pointer = (const void*)(baseOffset + attribute.offset);
+    if (attribute.integer)
+        glVertexAttribIPointer(attribute.location, attribute.components, attribute.glType, stride, pointer);
+    else
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.glType,
+                              attribute.normalized ? GL_TRUE : GL_FALSE, stride, pointer);
+    glEnableVertexAttribArray(attribute.location);
+    if (divisor)
+        glVertexAttribDivisor(attribute.location, divisor);
+}
+} // namespace vertex_format
+
+#define VERTEX_DECLARE_ATTRIBUTE(location, type, name) vertex_format::type name;
+#define VERTEX_COUNT_ATTRIBUTE(location, type, name) +1
+#define VERTEX_ATTRIBUTE_INFO(location, type, name) \
+    vertex_format::attribute<vertex_format::type>(location, offsetof(Self, name), #name),
+
+#define VERTEX_LAYOUT(Name, ATTRIBUTES)                                                                  \
+    struct Name                                                                                          \
+    {                                                                                                    \
+        typedef Name Self;                                                                               \
+        ATTRIBUTES(VERTEX_DECLARE_ATTRIBUTE)                                                             \
+        static constexpr size_t attributeCount = 0 ATTRIBUTES(VERTEX_COUNT_ATTRIBUTE);                  \
+        static constexpr std::array<vertex_format::Attribute, attributeCount> attributes()               \
+        {                                                                                                \
+            return {{ATTRIBUTES(VERTEX_ATTRIBUTE_INFO)}};                                                \
+        }                                                                                                \
+        /* for the bound VAO and GL_ARRAY_BUFFER; a divisor makes them per instance */                  \
+        static void setupAttributes(size_t baseOffset = 0, GLuint divisor = 0)                           \
+        {                                                                                                \
+            for (const vertex_format::Attribute& attribute : attributes())                               \
+                vertex_format::enable(attribute, (GLsizei)sizeof(Self), baseOffset, divisor);            \
+        }                                                                                                \
+        static std::string glsl()                                                                        \
+        {                                                                                                \
+            std::string text;                                                                            \
+            for (const vertex_format::Attribute& attribute : attributes())                               \
+                text += "layout (location = " + std::to_string(attribute.location) + ") in " +           \
+                        attribute.glsl + " " + attribute.name + ";\n";                                   \
+            return text;                                                                                 \
+        }                                                                                                \
+    };                                                                                                   \
+    static_assert(vertex_format::firstGap(Name::attributes()) < 0,                                      \
+                  #Name ": an attribute is padded or not 4 byte aligned, reorder the attributes");        \
+    static_assert(sizeof(Name) == vertex_format::packedSize(Name::attributes()),                        \
+                  #Name ": the struct has trailing padding, the stride would not match the attributes")
+
+#endif
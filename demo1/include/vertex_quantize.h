@@ -0,0 +1,353 @@
+#ifndef VERTEX_QUANTIZE_H
+#define VERTEX_QUANTIZE_H
+
+#include <glad/glad.h>
+
+#include <shader_s.h>
+#include <vertex_layout.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Interleaved float vertices (position, color, texture coords; 32 bytes in demo1)
+// re-encoded into smaller attributes to cut vertex fetch bandwidth:
+//   positions  half floats or 16 bit integers, relative to the mesh's bounding box
+//   colors     GL_UNSIGNED_INT_2_10_10_10_REV or RGBA8, clamped to [0, 1]
+//   tex coords normalized 16 bit, relative to the mesh's texture coordinate range
+// The per-mesh offsets and scales are uniforms; QuantizedMesh::glsl() writes the
+// attribute inputs together with decodePosition() / decodeColor() / decodeTexCoord()
+// for the vertex shader, so shaders do not hard-code an encoding. Every encoding
+// reports the largest error it can introduce and the largest it did introduce.
+// ------------------------------------------------------------------------
+namespace vertex_quantize
+{
+// IEEE binary16, rounded to nearest even; out of range values become infinity
+inline uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t magnitude = bits & 0x7fffffff;
+    if (magnitude >= 0x7f800000) // infinity and NaN
+        return (uint16_t)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+    if (magnitude >= 0x477ff000) // rounds above 65504
+        return (uint16_t)(sign | 0x7c00);
+    if (magnitude < 0x33000000) // rounds to zero
+        return (uint16_t)sign;
+    if (magnitude < 0x38800000) // half denormals: multiples of 2^-24
+    {
+        const uint32_t shift = 126 - (magnitude >> 23);
+        const uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1)))
+            ++half;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = (magnitude >> 13) - ((127 - 15) << 10);
+    const uint32_t rest = magnitude & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+        ++half; // a carry into the exponent is still the right value
+    return (uint16_t)(sign | half);
+}
+inline float halfToFloat(uint16_t half)
+{
+    const uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+    if (exponent == 0)
+        return (sign ? -1.0f : 1.0f) * (float)mantissa * (1.0f / 16777216.0f);
+    const uint32_t bits = exponent == 0x1f ? sign | 0x7f800000 | (mantissa << 13)
+                                           : sign | ((exponent + 112) << 23) | (mantissa << 13);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+// [0, 1] to 0 .. 2^bits - 1, which GL normalizes back by dividing
+inline uint32_t toUnorm(float value, int bits)
+{
+    const float top = (float)((1u << bits) - 1);
+    return (uint32_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * top);
+}
+inline float fromUnorm(uint32_t value, int bits)
+{
+    return (float)value / (float)((1u << bits) - 1);
+}
+// x in bits 0-9, y 10-19, z 20-29, w 30-31 (GL_UNSIGNED_INT_2_10_10_10_REV)
+inline uint32_t packUnorm10_10_10_2(float x, float y, float z, float w)
+{
+    return toUnorm(x, 10) | toUnorm(y, 10) << 10 | toUnorm(z, 10) << 20 | toUnorm(w, 2) << 30;
+}
+} // namespace vertex_quantize
+
+enum class PositionEncoding { Float, Half, Int16 };
+enum class ColorEncoding { Float, Unorm10_10_10_2, Unorm8 };
+enum class TexCoordEncoding { Float, Unorm16 };
+
+struct QuantizeOptions
+{
+    PositionEncoding position = PositionEncoding::Int16;
+    ColorEncoding color = ColorEncoding::Unorm10_10_10_2;
+    TexCoordEncoding texCoord = TexCoordEncoding::Unorm16;
+    // the source vertices, in floats
+    size_t stride = 8;
+    size_t positionOffset = 0;
+    size_t colorOffset = 3;
+    size_t texCoordOffset = 6;
+};
+
+// largest absolute error per component: position in mesh units, color in [0, 1],
+// texture coords in texture units
+struct QuantizeError
+{
+    float position = 0.0f;
+    float color = 0.0f;
+    float texCoord = 0.0f;
+};
+
+// ------------------------------------------------------------------------
+class QuantizedMesh
+{
+public:
+    std::vector<unsigned char> data;
+    size_t vertexCount = 0;
+    size_t stride = 0;
+    QuantizeOptions options;
+    std::vector<vertex_format::Attribute> attributes; // aPos, aColor, aTexCoord at locations 0, 1, 2
+    // decodePosition() = positionOffset + positionScale * aPos.xyz, likewise for texture coords
+    float positionOffset[3] = {0.0f, 0.0f, 0.0f};
+    float positionScale[3] = {1.0f, 1.0f, 1.0f};
+    float texCoordOffset[2] = {0.0f, 0.0f};
+    float texCoordScale[2] = {1.0f, 1.0f};
+    QuantizeError bound;    // what the encodings allow for this mesh's ranges
+    QuantizeError measured; // what they did to these vertices, color clamping included
+
+    // for the bound VAO and GL_ARRAY_BUFFER holding `data`
+    void setupAttributes(size_t baseOffset = 0) const
+    {
+        for (const vertex_format::Attribute& attribute : attributes)
+            vertex_format::enable(attribute, (GLsizei)stride, baseOffset, 0);
+    }
+    // the inputs, decode uniforms and decode functions, to paste after #version
+    std::string glsl() const
+    {
+        std::string text;
+        for (const vertex_format::Attribute& attribute : attributes)
+            text += "layout (location = " + std::to_string(attribute.location) + ") in " + attribute.glsl + " " +
+                    attribute.name + ";\n";
+        if (options.position == PositionEncoding::Float)
+            text += "vec3 decodePosition() { return aPos; }\n";
+        else
+            text += "uniform vec3 decodePositionOffset;\n"
+                    "uniform vec3 decodePositionScale;\n"
+                    "vec3 decodePosition() { return decodePositionOffset + decodePositionScale * aPos.xyz; }\n";
+        text += options.color == ColorEncoding::Float ? "vec3 decodeColor() { return aColor; }\n"
+                                                      : "vec3 decodeColor() { return aColor.rgb; }\n";
+        if (options.texCoord == TexCoordEncoding::Float)
+            text += "vec2 decodeTexCoord() { return aTexCoord; }\n";
+        else
+            text += "uniform vec2 decodeTexCoordOffset;\n"
+                    "uniform vec2 decodeTexCoordScale;\n"
+                    "vec2 decodeTexCoord() { return decodeTexCoordOffset + decodeTexCoordScale * aTexCoord; }\n";
+        return text;
+    }
+    // through the shader's uniform table, so its shadow copy stays in step; uniforms the
+    // encoding does not need are not active and are skipped
+    void setDecodeUniforms(Shader& shader) const
+    {
+        shader.setFloats("decodePositionOffset", positionOffset, 3);
+        shader.setFloats("decodePositionScale", positionScale, 3);
+        shader.setFloats("decodeTexCoordOffset", texCoordOffset, 2);
+        shader.setFloats("decodeTexCoordScale", texCoordScale, 2);
+    }
+
+    void report() const
+    {
+        std::cout << "VERTEX::QUANTIZE: " << vertexCount << " vertices, " << options.stride * sizeof(float) << " -> "
+                  << stride << " bytes each; max error position " << measured.position << " (bound " << bound.position
+                  << "), color " << measured.color << " (bound " << bound.color << "), texcoord " << measured.texCoord
+                  << " (bound " << bound.texCoord << ")" << std::endl;
+    }
+};
+
+// ------------------------------------------------------------------------
+inline QuantizedMesh quantizeVertices(const float* vertices, size_t vertexCount, const QuantizeOptions& options = QuantizeOptions())
+{
+    using namespace vertex_quantize;
+    QuantizedMesh mesh;
+    mesh.vertexCount = vertexCount;
+    mesh.options = options;
+    const size_t positionSize = options.position == PositionEncoding::Float ? sizeof(vertex_format::Vec3) : 8;
+    const size_t colorSize = options.color == ColorEncoding::Float ? sizeof(vertex_format::Vec3) : 4;
+    const size_t texCoordSize = options.texCoord == TexCoordEncoding::Float ? sizeof(vertex_format::Vec2) : 4;
+    const size_t colorAt = positionSize, texCoordAt = positionSize + colorSize;
+    mesh.stride = positionSize + colorSize + texCoordSize;
+    switch (options.position)
+    {
+    case PositionEncoding::Float: mesh.attributes.push_back(vertex_format::attribute<vertex_format::Vec3>(0, 0, "aPos")); break;
+    case PositionEncoding::Half: mesh.attributes.push_back(vertex_format::attribute<vertex_format::Half4>(0, 0, "aPos")); break;
+    case PositionEncoding::Int16: mesh.attributes.push_back(vertex_format::attribute<vertex_format::Int16x4>(0, 0, "aPos")); break;
+    }
+    switch (options.color)
+    {
+    case ColorEncoding::Float: mesh.attributes.push_back(vertex_format::attribute<vertex_format::Vec3>(1, colorAt, "aColor")); break;
+    case ColorEncoding::Unorm10_10_10_2:
+        mesh.attributes.push_back(vertex_format::attribute<vertex_format::Unorm10_10_10_2>(1, colorAt, "aColor"));
+        break;
+    case ColorEncoding::Unorm8: mesh.attributes.push_back(vertex_format::attribute<vertex_format::Unorm8x4>(1, colorAt, "aColor")); break;
+    }
+    if (options.texCoord == TexCoordEncoding::Float)
+        mesh.attributes.push_back(vertex_format::attribute<vertex_format::Vec2>(2, texCoordAt, "aTexCoord"));
+    else
+        mesh.attributes.push_back(vertex_format::attribute<vertex_format::Unorm16x2>(2, texCoordAt, "aTexCoord"));
+    mesh.data.resize(vertexCount * mesh.stride);
+    if (vertexCount == 0)
+        return mesh;
+
+    // ranges: positions map the bounding box to [-1, 1] (half) or [-32767, 32767] (int16)
+    // around its center, texture coords their range to [0, 1]
+    float low[5], high[5];
+    for (int c = 0; c < 5; ++c)
+    {
+        low[c] = INFINITY;
+        high[c] = -INFINITY;
+    }
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* vertex = vertices + i * options.stride;
+        for (int c = 0; c < 5; ++c)
+        {
+            const float value = c < 3 ? vertex[options.positionOffset + c] : vertex[options.texCoordOffset + c - 3];
+            low[c] = std::min(low[c], value);
+            high[c] = std::max(high[c], value);
+        }
+    }
+    float extent[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        extent[c] = (high[c] - low[c]) * 0.5f; // a flat axis keeps a scale of 1 and encodes 0
+        if (options.position != PositionEncoding::Float)
+        {
+            mesh.positionOffset[c] = low[c] + extent[c];
+            mesh.positionScale[c] = extent[c] > 0.0f ? extent[c] : 1.0f;
+            if (options.position == PositionEncoding::Int16)
+                mesh.positionScale[c] /= 32767.0f;
+        }
+    }
+    if (options.texCoord == TexCoordEncoding::Unorm16)
+        for (int c = 0; c < 2; ++c)
+        {
+            mesh.texCoordOffset[c] = low[3 + c];
+            mesh.texCoordScale[c] = high[3 + c] > low[3 + c] ? high[3 + c] - low[3 + c] : 1.0f;
+        }
+    const float largestExtent = std::max(extent[0], std::max(extent[1], extent[2]));
+    // plus the float rounding of offset + scale * value, about one ulp of the result
+    float largestPosition = 0.0f, largestTexCoord = 0.0f;
+    for (int c = 0; c < 5; ++c)
+    {
+        float& largest = c < 3 ? largestPosition : largestTexCoord;
+        largest = std::max(largest, std::max(std::fabs(low[c]), std::fabs(high[c])));
+    }
+    // half: 11 significant bits, at most half a unit in the last place 2^-11 below 1.0
+    mesh.bound.position = options.position == PositionEncoding::Half  ? largestExtent / 4096.0f + largestPosition * FLT_EPSILON
+                        : options.position == PositionEncoding::Int16 ? largestExtent / 32767.0f * 0.5f + largestPosition * FLT_EPSILON
+                                                                      : 0.0f;
+    mesh.bound.color = options.color == ColorEncoding::Unorm10_10_10_2 ? 0.5f / 1023.0f
+                     : options.color == ColorEncoding::Unorm8          ? 0.5f / 255.0f
+                                                                        : 0.0f;
+    mesh.bound.texCoord = options.texCoord == TexCoordEncoding::Unorm16
+                              ? std::max(mesh.texCoordScale[0], mesh.texCoordScale[1]) * 0.5f / 65535.0f +
+                                    largestTexCoord * FLT_EPSILON
+                              : 0.0f;
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* vertex = vertices + i * options.stride;
+        unsigned char* out = &mesh.data[i * mesh.stride];
+        const float* position = vertex + options.positionOffset;
+        const float* color = vertex + options.colorOffset;
+        const float* texCoord = vertex + options.texCoordOffset;
+        float decoded[3];
+        switch (options.position)
+        {
+        case PositionEncoding::Float:
+            std::memcpy(out, position, 3 * sizeof(float));
+            std::memcpy(decoded, position, 3 * sizeof(float));
+            break;
+        case PositionEncoding::Half:
+        {
+            uint16_t half[4] = {0, 0, 0, 0};
+            for (int c = 0; c < 3; ++c)
+            {
+                half[c] = floatToHalf((position[c] - mesh.positionOffset[c]) / mesh.positionScale[c]);
+                decoded[c] = mesh.positionOffset[c] + mesh.positionScale[c] * halfToFloat(half[c]);
+            }
+            std::memcpy(out, half, sizeof(half));
+            break;
+        }
+        case PositionEncoding::Int16:
+        {
+            int16_t integer[4] = {0, 0, 0, 0};
+            for (int c = 0; c < 3; ++c)
+            {
+                const long q = std::lround((position[c] - mesh.positionOffset[c]) / mesh.positionScale[c]);
+                integer[c] = (int16_t)std::min(std::max(q, -32767L), 32767L);
+                decoded[c] = mesh.positionOffset[c] + mesh.positionScale[c] * integer[c];
+            }
+            std::memcpy(out, integer, sizeof(integer));
+            break;
+        }
+        }
+        for (int c = 0; c < 3; ++c)
+            mesh.measured.position = std::max(mesh.measured.position, std::fabs(decoded[c] - position[c]));
+
+        switch (options.color)
+        {
+        case ColorEncoding::Float:
+            std::memcpy(out + colorAt, color, 3 * sizeof(float));
+            std::memcpy(decoded, color, 3 * sizeof(float));
+            break;
+        case ColorEncoding::Unorm10_10_10_2:
+        {
+            const uint32_t packed = packUnorm10_10_10_2(color[0], color[1], color[2], 1.0f);
+            std::memcpy(out + colorAt, &packed, sizeof(packed));
+            for (int c = 0; c < 3; ++c)
+                decoded[c] = fromUnorm((packed >> (10 * c)) & 0x3ff, 10);
+            break;
+        }
+        case ColorEncoding::Unorm8:
+        {
+            const uint8_t rgba[4] = {(uint8_t)toUnorm(color[0], 8), (uint8_t)toUnorm(color[1], 8),
+                                     (uint8_t)toUnorm(color[2], 8), 255};
+            std::memcpy(out + colorAt, rgba, sizeof(rgba));
+            for (int c = 0; c < 3; ++c)
+                decoded[c] = fromUnorm(rgba[c], 8);
+            break;
+        }
+        }
+        for (int c = 0; c < 3; ++c)
+            mesh.measured.color = std::max(mesh.measured.color, std::fabs(decoded[c] - color[c]));
+
+        if (options.texCoord == TexCoordEncoding::Float)
+        {
+            std::memcpy(out + texCoordAt, texCoord, 2 * sizeof(float));
+            continue;
+        }
+        uint16_t unorm[2];
+        for (int c = 0; c < 2; ++c)
+        {
+            unorm[c] = (uint16_t)toUnorm((texCoord[c] - mesh.texCoordOffset[c]) / mesh.texCoordScale[c], 16);
+            const float value = mesh.texCoordOffset[c] + mesh.texCoordScale[c] * fromUnorm(unorm[c], 16);
+            mesh.measured.texCoord = std::max(mesh.measured.texCoord, std::fabs(value - texCoord[c]));
+        }
+        std::memcpy(out + texCoordAt, unorm, sizeof(unorm));
+    }
+    return mesh;
+}
+
+#endif
@@ -1,3 +1,5 @@
+// archived tutorial step, not part of the build: textures are loaded by hand on purpose;
+// src/main.cpp loads them through TextureCache (texture_cache.h)
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #define STB_IMAGE_IMPLEMENTATION
@@ -0,0 +1,27 @@
+#pragma once
+// TEXTURE_COUNT 1: texture1 tinted by the vertex color
+// TEXTURE_COUNT 2: texture1 and texture2 mixed by MIX_AMOUNT
+#ifndef TEXTURE_COUNT
+#define TEXTURE_COUNT 1
+#endif
+#ifndef MIX_AMOUNT
+#define MIX_AMOUNT 0.2
+#endif
+
+in vec3 ourColor;
+in vec2 TexCoord;
+
+// texture samplers
+uniform sampler2D texture1;
+#if TEXTURE_COUNT >= 2
+uniform sampler2D texture2;
+#endif
+
+vec4 sampleTextures(vec2 uv)
+{
+#if TEXTURE_COUNT >= 2
+    return mix(texture(texture1, uv), texture(texture2, uv), MIX_AMOUNT);
+#else
+    return texture(texture1, uv) * vec4(ourColor, 1.0);
+#endif
+}
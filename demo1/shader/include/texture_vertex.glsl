@@ -0,0 +1,8 @@
+#pragma once
+// interleaved vertex of the textured quads: position, color, texture coords
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 ourColor;
+out vec2 TexCoord;
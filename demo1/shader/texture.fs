@@ -0,0 +1,9 @@
+#version 330 core
+out vec4 FragColor;
+
+#include "include/texture_sampling.glsl"
+
+void main()
+{
+    FragColor = sampleTextures(TexCoord);
+}
@@ -0,0 +1,9 @@
+#version 330 core
+#include "include/texture_vertex.glsl"
+
+void main()
+{
+    gl_Position = vec4(aPos, 1.0);
+    ourColor = aColor;
+    TexCoord = aTexCoord;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TexCoord;
+
+// every image of the batch, one per layer
+uniform sampler2DArray textures;
+
+void main()
+{
+    FragColor = texture(textures, TexCoord);
+}
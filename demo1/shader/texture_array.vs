@@ -0,0 +1,16 @@
+#version 330 core
+// quads with their image taken from a layer of a texture array. Per instance (attribute
+// divisor 1) for instanced draws of one quad, or per vertex with the instance
+// attribute left disabled (glVertexAttrib3f(3, 0.0, 0.0, 1.0)) for pre-transformed quads
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in vec3 aOffsetScale; // xy offset, z scale
+layout (location = 4) in float aLayer;
+
+out vec3 TexCoord; // xy texture coords, z layer
+
+void main()
+{
+    gl_Position = vec4(aPos.xy * aOffsetScale.z + aOffsetScale.xy, aPos.z, 1.0);
+    TexCoord = vec3(aTexCoord, aLayer);
+}
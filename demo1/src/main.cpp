@@ -5,18 +5,32 @@
 #include "stb_image.h"
 
 #include <shader_s.h>
+#include <shader_files.h>
+#include <shader_permutations.h>
+#include <shader_warmup.h>
+#include <shader_watcher.h>
+#include <mesh_builder.h>
+#include <texture_cache.h>
+#include <vertex_layout.h>
 
+#include <chrono>
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
+void drawLoadingScreen(GLFWwindow* window, float progress);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// the vertex of the textured quad, matching shader/include/texture_vertex.glsl
+#define TEXTURED_VERTEX(ATTRIBUTE) ATTRIBUTE(0, Vec3, aPos) ATTRIBUTE(1, Vec3, aColor) ATTRIBUTE(2, Vec2, aTexCoord)
+VERTEX_LAYOUT(TexturedVertex, TEXTURED_VERTEX);
+
 int main()
 {
+    auto startupBegin = std::chrono::steady_clock::now();
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -47,117 +61,138 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // entry points newer than GL 3.3 (program binaries, ...), when the driver has them
+    glext::load((GLADloadproc)glfwGetProcAddress);
 
-    // build and compile our shader zprogram
+    // build and compile our shader zprogram, linked programs of earlier runs are kept in shader_cache/
+    // the build is only submitted here and overlaps with the texture loading below, use() waits for it
     // ------------------------------------
-    Shader ourShader("../shader/4.2.texture.vs", "../shader/4.2.texture.fs");
+    ProgramBinaryCache shaderCache("shader_cache");
+#ifdef DEMO1_EMBED_SHADERS
+    // shader/ is compiled into the executable, no shader file I/O at all
+    ShaderPreprocessor preprocessor([](const std::string& name) {
+        const EmbeddedShader* shader = findEmbeddedShader(name);
+        return shader ? shader->view() : std::string_view();
+    });
+#else
+    ShaderFileSet shaderFiles("../shader"); // every shader file, memory mapped in one pass
+    ShaderPreprocessor preprocessor([&](const std::string& name) { return shaderFiles.find(name); });
+#endif
+    // texture.vs/fs with both textures mixed; the one texture variant would just be another define set
+    ShaderPermutations shaders(preprocessor, &shaderCache);
+    Shader& ourShader = shaders.get("texture.vs", "texture.fs", {{"TEXTURE_COUNT", "2"}});
+    shaderCache.report(std::cout);
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
-    float vertices[] = {
-        // positions          // colors           // texture coords
-         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
-         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
-        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
-        -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left 
+    TexturedVertex vertices[] = {
+        // positions            // colors             // texture coords
+        {{ 0.5f,  0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f}}, // top right
+        {{ 0.5f, -0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}}, // bottom right
+        {{-0.5f, -0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}}, // bottom left
+        {{-0.5f,  0.5f, 0.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 1.0f}}  // top left
     };
-    unsigned int indices[] = {
+    uint32_t indices[] = {
         0, 1, 3, // first triangle
         1, 2, 3  // second triangle
     };
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // uploaded with the smallest index type that fits, GL_UNSIGNED_BYTE for the quad;
+    // position, color and texture coord attributes from the layout
+    MeshBuilder meshes;
+    Mesh quad = meshes.setVertices(vertices, 4).setIndices(indices, 6).build([] { TexturedVertex::setupAttributes(); });
 
 
     // load and create a texture 
     // -------------------------
-    unsigned int texture1, texture2;
-    // texture 1
-    // ---------
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1); 
-     // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.stb_image.h能够在图像加载时帮助我们翻转y轴
-    // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
-    unsigned char *data = stbi_load("../resources/textures/1.jpg", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-    // texture 2
-    // ---------
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    data = stbi_load("../resources/textures/2.png", &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        // note that the awesomeface.png has transparency and thus an alpha channel, so make sure to tell OpenGL the data type is of GL_RGBA
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
+    // textures cooked by the texcook target (cooked/*.ctex, already flipped and with all their
+    // mips) are mapped and uploaded at once. Otherwise decoding runs on worker threads and the
+    // texture shows a grey placeholder until textures.update() has uploaded it on a later frame.
+    // The cache loads each file (with the same sampling parameters) once; a texture stays
+    // resident while a handle refers to it, and after that until the budget needs its memory.
+    // Cooked textures stream their mips: they start with the levels up to 64x64 and get the
+    // finer ones as the render loop asks for them, within the streamer's budget
+    TextureCache textures(64 << 20);
+    textures.streamer().budget = 32 << 20;
+    auto loadTexture = [&](const std::string& name) {
+        TextureDesc desc;
+        desc.path = "../resources/textures/" + name; // flipped on the y-axis, like stbi_set_flip_vertically_on_load(true)
+        // set the texture wrapping parameters
+        desc.wrapS = GL_REPEAT;	// set texture wrapping to GL_REPEAT (default wrapping method)
+        desc.wrapT = GL_REPEAT;
+        // set texture filtering parameters
+        desc.minFilter = GL_LINEAR;
+        desc.magFilter = GL_LINEAR;
+        desc.streamMips = true;
+        return textures.acquire(desc);
+    };
+    TextureHandle texture1 = loadTexture("1.jpg");
+    TextureHandle texture2 = loadTexture("2.png"); // has an alpha channel, uploaded as GL_RGBA
+
+    // warm-up: finish every program and draw it once offscreen with our vertex layout behind a
+    // loading screen, a few ms per frame, so the driver's late compile never hits a real frame
+    // -------------------------------------------------------------------------------------------
+    const double WARMUP_BUDGET_MS = 4.0;
+    ShaderWarmup warmup;
+    warmup.addPrograms(shaders);
+    warmup.addLayout(quad.vao(), quad.indexType());
+    while (!glfwWindowShouldClose(window) && !warmup.step(WARMUP_BUDGET_MS))
     {
-        std::cout << "Failed to load texture" << std::endl;
+        processInput(window);
+        textures.update();
+        drawLoadingScreen(window, warmup.progress());
+        glfwSwapBuffers(window);
+        glfwPollEvents();
     }
-    stbi_image_free(data);
 
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once,
+    // and again for the new program whenever hot reload swaps one in)
     // -------------------------------------------------------------------------------------------
-    ourShader.use(); // don't forget to activate/use the shader before setting uniforms!
-    // either set it manually like so:
-    glUniform1i(glGetUniformLocation(ourShader.ID, "texture1"), 0);
-    // or set it via the texture class
-    ourShader.setInt("texture2", 1);
+    auto bindSamplers = [](Shader& shader) {
+        shader.use(); // don't forget to activate/use the shader before setting uniforms!
+        shader.set(shader.getUniform<int>("texture1"_uh), 0);
+        shader.set(shader.getUniform<int>("texture2"_uh), 1);
+    };
+    bindSamplers(ourShader);
+    shaders.onReload = bindSamplers;
+#ifndef DEMO1_EMBED_SHADERS
+    // edits to ../shader/* show up without a restart
+    ShaderHotReload hotReload(shaderFiles, preprocessor, shaders);
+#endif
 
 
 
     // render loop
     // -----------
+    bool startupReported = false;
     while (!glfwWindowShouldClose(window))
     {
         // input
         // -----
         processInput(window);
+#ifndef DEMO1_EMBED_SHADERS
+        hotReload.update();
+#endif
+        // the quad spans half the framebuffer each way; the streamer wants the mip level whose
+        // texels match that, requested before update() so this frame's uploads can follow it
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        for (const TextureHandle* texture : {&texture1, &texture2})
+            textures.streamer().request(texture->id(), framebufferWidth * 0.5f, framebufferHeight * 0.5f);
+        textures.update();
+        if (!startupReported && textures.loader().pending() == 0 && textures.streamer().pending() == 0)
+        {
+            // compare a run with cooked/ against one without it
+            startupReported = true;
+            std::cout << "STARTUP: first frame with every texture after "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count()
+                      << " ms (" << textures.loader().cookedLoaded << " of " << textures.loader().loaded << " textures cooked)" << std::endl;
+            TextureLoader::Timings stages = textures.loader().timings();
+            std::cout << "TEXTURE::STAGES: decode " << stages.decodeMs << " ms, post-decode " << stages.postDecodeMs
+                      << " ms, mips " << stages.mipsMs << " ms, copy " << stages.copyMs << " ms (worker time)" << std::endl;
+            textures.report();
+            textures.streamer().report();
+            meshes.report();
+        }
 
         // render
         // ------
@@ -166,14 +201,13 @@ int main()
 
         // bind textures on corresponding texture units
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
+        glBindTexture(GL_TEXTURE_2D, texture1.id());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
+        glBindTexture(GL_TEXTURE_2D, texture2.id());
 
         // render container
         ourShader.use();
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        quad.draw();
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -183,9 +217,10 @@ int main()
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    quad = Mesh();
+    texture1 = TextureHandle();
+    texture2 = TextureHandle();
+    textures.purge();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -201,6 +236,26 @@ void processInput(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
 }
 
+// loading screen: a progress bar drawn with scissored clears, it needs no shader of its own
+// ---------------------------------------------------------------------------------------------
+void drawLoadingScreen(GLFWwindow* window, float progress)
+{
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    int barWidth = width * 3 / 4, barHeight = height / 40 + 1;
+    int x = (width - barWidth) / 2, y = (height - barHeight) / 2;
+    glScissor(x, y, barWidth, barHeight);
+    glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glScissor(x, y, (int)(barWidth * progress), barHeight);
+    glClearColor(0.2f, 0.6f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
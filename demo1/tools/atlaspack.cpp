@@ -0,0 +1,104 @@
+// atlaspack [--size N] [--padding N] [--skyline] [--linear] <output dir> <images...>
+// Packs the images (flipped for GL like texcook) into RGBA atlas pages of N x N texels
+// (default 2048), writes <output dir>/atlas<page>.ctex with the mip levels that stay
+// free of bleeding, and <output dir>/atlas.txt with one line per image:
+//   <name> <page> <x> <y> <width> <height> <u0> <v0> <u1> <v1>
+// Images that do not fit on a page are left out with an error.
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <cooked_texture.h>
+#include <mapped_file.h>
+#include <post_decode.h>
+#include <texture_atlas.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    AtlasOptions options;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; ++first)
+    {
+        std::string flag = argv[first];
+        if (flag == "--size" && first + 1 < argc)
+            options.pageSize = std::atoi(argv[++first]);
+        else if (flag == "--padding" && first + 1 < argc)
+            options.padding = std::atoi(argv[++first]);
+        else if (flag == "--skyline")
+            options.heuristic = PackHeuristic::Skyline;
+        else if (flag == "--linear")
+            options.srgb = false;
+        else
+            first = argc;
+    }
+    if (first >= argc || options.pageSize <= 0 || options.padding < 0)
+    {
+        std::cout << "usage: atlaspack [--size N] [--padding N] [--skyline] [--linear] <output dir> <images...>" << std::endl;
+        return 1;
+    }
+    const std::filesystem::path outputDir = argv[first];
+    std::filesystem::create_directories(outputDir);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<MipImage> images;
+    std::vector<std::string> names;
+    int failures = 0;
+    for (int i = first + 1; i < argc; ++i)
+    {
+        const std::filesystem::path source = argv[i];
+        MappedFile file(source.string());
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = file.isOpen()
+            ? stbi_load_from_memory((const stbi_uc*)file.data(), (int)file.size(), &width, &height, &channels, 0)
+            : nullptr;
+        if (!pixels)
+        {
+            std::cout << "ERROR::ATLASPACK::LOAD_FAILED: " << source.string() << std::endl;
+            ++failures;
+            continue;
+        }
+        PostDecodeOptions post;
+        post.flipVertically = true;
+        post.outputChannels = 4;
+        images.push_back(postDecode(pixels, width, height, channels, post));
+        stbi_image_free(pixels);
+        names.push_back(source.filename().string());
+    }
+
+    Atlas atlas = buildAtlas(images, options);
+    for (size_t page = 0; page < atlas.pages.size(); ++page)
+    {
+        const std::filesystem::path output = outputDir / ("atlas" + std::to_string(page) + ".ctex");
+        if (!writeCookedTexture(output.string(), atlas.pages[page], CookedTextureHeader::FLIPPED))
+            ++failures;
+    }
+    std::ofstream manifest(outputDir / "atlas.txt");
+    for (size_t i = 0; i < atlas.entries.size(); ++i)
+    {
+        const AtlasEntry& entry = atlas.entries[i];
+        if (entry.page < 0)
+        {
+            ++failures;
+            continue;
+        }
+        manifest << names[i] << " " << entry.page << " " << entry.rect.x << " " << entry.rect.y << " "
+                 << entry.rect.width << " " << entry.rect.height << " " << entry.u0 << " " << entry.v0 << " "
+                 << entry.u1 << " " << entry.v1 << "\n";
+    }
+    if (!manifest)
+    {
+        std::cout << "ERROR::ATLASPACK::CANNOT_WRITE_MANIFEST: " << (outputDir / "atlas.txt").string() << std::endl;
+        ++failures;
+    }
+    atlas.report();
+    std::cout << "atlaspack: " << images.size() << " images in "
+              << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms"
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
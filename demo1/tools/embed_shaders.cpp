@@ -0,0 +1,84 @@
+// embed_shaders <output.h> <root dir> <files...>
+// Writes every file as a constexpr char array plus its fnv1a64 into one header,
+// used by the DEMO1_EMBED_SHADERS build step. Names are relative to the root dir.
+#include <fnv1a.h>
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: embed_shaders <output.h> <root dir> <files...>" << std::endl;
+        return 1;
+    }
+    const std::string outputPath = argv[1];
+    const std::filesystem::path root = argv[2];
+
+    std::vector<std::pair<std::string, std::string>> files; // name, path
+    for (int i = 3; i < argc; ++i)
+        files.push_back({std::filesystem::relative(argv[i], root).generic_string(), argv[i]});
+    // sorted by name so findEmbeddedShader can binary search
+    std::sort(files.begin(), files.end());
+
+    std::ostringstream out;
+    out << "// generated by tools/embed_shaders.cpp, do not edit\n"
+        << "#ifndef EMBEDDED_SHADERS_GENERATED_H\n"
+        << "#define EMBEDDED_SHADERS_GENERATED_H\n\n"
+        << "namespace embedded_shader_data\n{\n";
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        MappedFile file(files[i].second);
+        if (!file.isOpen())
+        {
+            std::cout << "ERROR::EMBED_SHADERS::FILE_NOT_SUCCESSFULLY_READ: " << files[i].second << std::endl;
+            return 1;
+        }
+        out << "// " << files[i].first << "\n"
+            << "inline constexpr char source" << i << "[] = {";
+        char byte[8];
+        for (size_t j = 0; j < file.size(); ++j)
+        {
+            std::snprintf(byte, sizeof(byte), "'\\x%02x',", (unsigned char)file.data()[j]);
+            out << (j % 16 == 0 ? "\n    " : "") << byte;
+        }
+        out << "\n    '\\0'\n};\n";
+        char hash[32];
+        std::snprintf(hash, sizeof(hash), "0x%016llxull", (unsigned long long)fnv1a64(file.data(), file.size()));
+        files[i].second = std::string("{\"") + files[i].first + "\", embedded_shader_data::source" + std::to_string(i) + ", " +
+                          std::to_string(file.size()) + ", " + hash + "}";
+    }
+    out << "} // namespace embedded_shader_data\n\n"
+        << "inline constexpr EmbeddedShader EMBEDDED_SHADERS[] = {\n";
+    for (const auto& file : files)
+        out << "    " << file.second << ",\n";
+    if (files.empty())
+        out << "    {\"\", \"\", 0, FNV1A64_OFFSET},\n";
+    out << "};\n\n#endif\n";
+
+    // leave the header untouched when nothing changed, so dependents are not rebuilt; the
+    // build tracks this step with a stamp file instead of the header's time
+    std::string contents = out.str();
+    {
+        MappedFile previous(outputPath);
+        if (previous.isOpen() && previous.view() == contents)
+            return 0;
+    }
+    std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path());
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    output << contents;
+    if (!output)
+    {
+        std::cout << "ERROR::EMBED_SHADERS::WRITE_FAILED: " << outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,292 @@
+// meshopt [--no-overdraw] [--threshold X] <input.obj> <output.obj>
+// Reorders the triangles of a Wavefront OBJ for the vertex cache and overdraw and its
+// vertices for fetch locality (mesh_optimize.h), the same passes MeshBuilder::optimize()
+// runs at load time, and prints the ACMR / ATVR after every pass. Polygons become
+// triangle fans; the output has one v/vt/vn per distinct corner, indexed in the new order.
+// Triangles are only reordered within their group (the faces between two usemtl / g / o / s
+// statements), and mtllib and the group statements are written back in place; any other
+// statement (l, p, curves) is refused rather than dropped.
+#include <mesh_optimize.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ObjMesh
+{
+    std::vector<float> positions, texCoords, normals;
+    // welded corners: position, texture coord and normal index (-1: none)
+    std::vector<int> corners;
+    std::vector<uint32_t> indices;
+    // the faces after a run of usemtl / g / o / s statements
+    struct FaceGroup
+    {
+        std::string statements;
+        size_t firstIndex = 0;
+        size_t indexCount = 0;
+    };
+    std::vector<FaceGroup> groups = std::vector<FaceGroup>(1);
+    std::string header; // mtllib lines
+};
+
+// 1-based, negative counts back from the end; -1 when missing or out of range
+static int objIndex(const char* text, size_t count)
+{
+    if (!*text)
+        return -1;
+    long index = std::strtol(text, nullptr, 10);
+    index = index < 0 ? (long)count + index : index - 1;
+    return index >= 0 && index < (long)count ? (int)index : -1;
+}
+
+// welding key: the resolved position, texture coord and normal of a corner
+struct CornerKey
+{
+    int p, t, n;
+    bool operator==(const CornerKey& other) const { return p == other.p && t == other.t && n == other.n; }
+};
+struct CornerKeyHash
+{
+    size_t operator()(const CornerKey& key) const
+    {
+        return std::hash<uint64_t>()(((uint64_t)(uint32_t)key.p << 32 | (uint32_t)key.t) * 31 + (uint32_t)key.n);
+    }
+};
+
+static bool readObj(const char* path, ObjMesh& mesh)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    // welded on the resolved indices, not the text: "-1" names another vertex on every line
+    std::unordered_map<CornerKey, uint32_t, CornerKeyHash> welded;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        std::istringstream in(line);
+        std::string tag;
+        in >> tag;
+        float x = 0.0f, y = 0.0f, z = 0.0f;
+        if (tag.empty() || tag[0] == '#')
+            continue;
+        else if (tag == "mtllib")
+            mesh.header += line + "\n";
+        else if (tag == "usemtl" || tag == "g" || tag == "o" || tag == "s")
+        {
+            if (mesh.groups.back().indexCount)
+            {
+                mesh.groups.emplace_back();
+                mesh.groups.back().firstIndex = mesh.indices.size();
+            }
+            mesh.groups.back().statements += line + "\n";
+        }
+        else if (tag == "v" && in >> x >> y >> z)
+            mesh.positions.insert(mesh.positions.end(), {x, y, z});
+        else if (tag == "vt" && in >> x >> y)
+            mesh.texCoords.insert(mesh.texCoords.end(), {x, y});
+        else if (tag == "vn" && in >> x >> y >> z)
+            mesh.normals.insert(mesh.normals.end(), {x, y, z});
+        else if (tag == "f")
+        {
+            std::vector<uint32_t> polygon;
+            std::string corner;
+            while (in >> corner)
+            {
+                const size_t slash = corner.find('/'), second = slash == std::string::npos ? slash : corner.find('/', slash + 1);
+                CornerKey key;
+                key.p = objIndex(corner.c_str(), mesh.positions.size() / 3);
+                key.t = slash == std::string::npos ? -1 : objIndex(corner.c_str() + slash + 1, mesh.texCoords.size() / 2);
+                key.n = second == std::string::npos ? -1 : objIndex(corner.c_str() + second + 1, mesh.normals.size() / 3);
+                if (key.p < 0)
+                {
+                    std::cout << "ERROR::MESHOPT::BAD_FACE: " << line << std::endl;
+                    return false;
+                }
+                auto found = welded.emplace(key, (uint32_t)(mesh.corners.size() / 3));
+                if (found.second)
+                    mesh.corners.insert(mesh.corners.end(), {key.p, key.t, key.n});
+                polygon.push_back(found.first->second);
+            }
+            for (size_t i = 2; i < polygon.size(); ++i)
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            mesh.groups.back().indexCount = mesh.indices.size() - mesh.groups.back().firstIndex;
+        }
+        else if (tag != "v" && tag != "vt" && tag != "vn")
+        {
+            std::cout << "ERROR::MESHOPT::UNSUPPORTED_STATEMENT: " << line << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool writeObj(const char* path, const ObjMesh& mesh, const std::vector<float>& vertices, size_t vertexCount)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    const bool texCoords = !mesh.texCoords.empty(), normals = !mesh.normals.empty();
+    file << mesh.header;
+    char line[128];
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const float* vertex = &vertices[v * 8];
+        std::snprintf(line, sizeof(line), "v %.9g %.9g %.9g\n", vertex[0], vertex[1], vertex[2]);
+        file << line;
+        if (texCoords)
+        {
+            std::snprintf(line, sizeof(line), "vt %.9g %.9g\n", vertex[3], vertex[4]);
+            file << line;
+        }
+        if (normals)
+        {
+            std::snprintf(line, sizeof(line), "vn %.9g %.9g %.9g\n", vertex[5], vertex[6], vertex[7]);
+            file << line;
+        }
+    }
+    for (const ObjMesh::FaceGroup& group : mesh.groups)
+    {
+        file << group.statements;
+        for (size_t i = group.firstIndex; i < group.firstIndex + group.indexCount; i += 3)
+        {
+            file << "f";
+            for (int k = 0; k < 3; ++k)
+            {
+                const uint32_t index = mesh.indices[i + k] + 1;
+                file << " " << index;
+                if (texCoords || normals)
+                    file << "/" << (texCoords ? std::to_string(index) : "") << (normals ? "/" + std::to_string(index) : "");
+            }
+            file << "\n";
+        }
+    }
+    return (bool)file;
+}
+
+// runs `pass(indices, indexCount, vertices, vertexCount)` on each group's triangles with the
+// vertices the group uses copied out and renumbered from 0, so a pass neither moves triangles
+// across groups nor walks every vertex of the file once per group
+template <typename Pass>
+static void forEachGroup(ObjMesh& mesh, const std::vector<float>& vertices, Pass&& pass)
+{
+    const uint32_t unused = 0xffffffffu;
+    std::vector<uint32_t> toLocal(vertices.size() / 8, unused), toGlobal;
+    std::vector<float> local;
+    for (const ObjMesh::FaceGroup& group : mesh.groups)
+    {
+        uint32_t* indices = mesh.indices.data() + group.firstIndex;
+        toGlobal.clear();
+        local.clear();
+        for (size_t i = 0; i < group.indexCount; ++i)
+        {
+            if (toLocal[indices[i]] == unused)
+            {
+                toLocal[indices[i]] = (uint32_t)toGlobal.size();
+                toGlobal.push_back(indices[i]);
+                local.insert(local.end(), &vertices[indices[i] * 8], &vertices[indices[i] * 8] + 8);
+            }
+            indices[i] = toLocal[indices[i]];
+        }
+        if (group.indexCount)
+            pass(indices, group.indexCount, local.data(), toGlobal.size());
+        for (size_t i = 0; i < group.indexCount; ++i)
+            indices[i] = toGlobal[indices[i]];
+        for (uint32_t vertex : toGlobal)
+            toLocal[vertex] = unused;
+    }
+}
+
+static void printStats(const char* pass, const ObjMesh& mesh, size_t vertexCount, double ms)
+{
+    VertexCacheStats stats = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    std::printf("%-14s ACMR %.3f  ATVR %.3f  (%.1f ms)\n", pass, stats.acmr(), stats.atvr(), ms);
+}
+
+int main(int argc, char** argv)
+{
+    bool overdraw = true;
+    float threshold = 1.05f;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; ++first)
+    {
+        std::string flag = argv[first];
+        if (flag == "--no-overdraw")
+            overdraw = false;
+        else if (flag == "--threshold" && first + 1 < argc)
+            threshold = (float)std::atof(argv[++first]);
+        else
+            first = argc;
+    }
+    if (first + 2 != argc || threshold < 1.0f)
+    {
+        std::cout << "usage: meshopt [--no-overdraw] [--threshold X] <input.obj> <output.obj>" << std::endl;
+        return 1;
+    }
+
+    ObjMesh mesh;
+    if (!readObj(argv[first], mesh) || mesh.indices.empty())
+    {
+        std::cout << "ERROR::MESHOPT::READ_FAILED: " << argv[first] << std::endl;
+        return 1;
+    }
+    // position, texture coord, normal per welded corner
+    size_t vertexCount = mesh.corners.size() / 3;
+    std::vector<float> vertices(vertexCount * 8, 0.0f);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const int* corner = &mesh.corners[v * 3];
+        float* vertex = &vertices[v * 8];
+        std::copy_n(&mesh.positions[corner[0] * 3], 3, vertex);
+        if (corner[1] >= 0)
+            std::copy_n(&mesh.texCoords[corner[1] * 2], 2, vertex + 3);
+        if (corner[2] >= 0)
+            std::copy_n(&mesh.normals[corner[2] * 3], 3, vertex + 5);
+    }
+    std::printf("%s: %zu triangles, %zu vertices, %zu groups\n", argv[first], mesh.indices.size() / 3, vertexCount,
+                mesh.groups.size());
+
+    auto time = [](auto&& pass) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    uint32_t* indices = mesh.indices.data();
+    const size_t indexCount = mesh.indices.size();
+    printStats("input", mesh, vertexCount, 0.0);
+    double ms = time([&] {
+        forEachGroup(mesh, vertices, [](uint32_t* groupIndices, size_t groupIndexCount, const float*, size_t groupVertexCount) {
+            optimizeVertexCache(groupIndices, groupIndexCount, groupVertexCount);
+        });
+    });
+    printStats("vertex cache", mesh, vertexCount, ms);
+    if (overdraw)
+    {
+        ms = time([&] {
+            forEachGroup(mesh, vertices, [&](uint32_t* groupIndices, size_t groupIndexCount, const float* groupVertices,
+                                             size_t groupVertexCount) {
+                optimizeOverdraw(groupIndices, groupIndexCount, groupVertices, groupVertexCount, 8 * sizeof(float), threshold);
+            });
+        });
+        printStats("overdraw", mesh, vertexCount, ms);
+    }
+    // renumbers vertices only, the triangle order and so the groups stay as they are
+    ms = time([&] { vertexCount = optimizeVertexFetch(vertices.data(), vertexCount, 8 * sizeof(float), indices, indexCount); });
+    printStats("vertex fetch", mesh, vertexCount, ms);
+
+    if (!writeObj(argv[first + 1], mesh, vertices, vertexCount))
+    {
+        std::cout << "ERROR::MESHOPT::WRITE_FAILED: " << argv[first + 1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+// texcook [--box] [--linear] [--compress] [--bc3] <output dir> <images...>
+// Decodes every image once (stb_image, flipped for GL like the demo loads them),
+// builds its mip chain and writes <output dir>/<name>.ctex for CookedTexture.
+// Mips use the Kaiser filter in linear light with premultiplied alpha unless
+// --box (2x2 average) or --linear (data that is not sRGB colour) are given.
+// --compress stores BC1 for images without alpha and BC7 for the others (BC3
+// with --bc3), and prints the PSNR of the largest level.
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <block_compression.h>
+#include <cooked_texture.h>
+#include <mapped_file.h>
+#include <mip_chain.h>
+#include <post_decode.h>
+#include <thread_pool.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    MipOptions options;
+    options.filter = MipFilter::Kaiser;
+    options.srgb = true;
+    bool compress = false, bc3 = false;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; ++first)
+    {
+        std::string flag = argv[first];
+        if (flag == "--box")
+            options.filter = MipFilter::Box;
+        else if (flag == "--linear")
+            options.srgb = false;
+        else if (flag == "--compress")
+            compress = true;
+        else if (flag == "--bc3")
+            bc3 = true;
+        else
+            first = argc;
+    }
+    if (first >= argc)
+    {
+        std::cout << "usage: texcook [--box] [--linear] [--compress] [--bc3] <output dir> <images...>" << std::endl;
+        return 1;
+    }
+    const std::filesystem::path outputDir = argv[first];
+    std::filesystem::create_directories(outputDir);
+    ThreadPool pool;
+
+    int failures = 0;
+    for (int i = first + 1; i < argc; ++i)
+    {
+        const std::filesystem::path source = argv[i];
+        const std::filesystem::path output = outputDir / (source.stem().string() + ".ctex");
+
+        auto start = std::chrono::steady_clock::now();
+        MappedFile file(source.string());
+        int width = 0, height = 0, channels = 0;
+        unsigned char* pixels = file.isOpen()
+            ? stbi_load_from_memory((const stbi_uc*)file.data(), (int)file.size(), &width, &height, &channels, 0)
+            : nullptr;
+        if (!pixels)
+        {
+            std::cout << "ERROR::TEXCOOK::LOAD_FAILED: " << source.string() << std::endl;
+            ++failures;
+            continue;
+        }
+        // flipped for GL while copying out of stb's buffer; channels stay as they are,
+        // BC1 and the file size do not gain anything from an alpha channel
+        PostDecodeOptions post;
+        post.flipVertically = true;
+        MipImage base = postDecode(pixels, width, height, channels, post);
+        stbi_image_free(pixels);
+
+        std::vector<MipImage> chain = buildMipChain(std::move(base), options);
+        const bool alpha = chain[0].channels == 2 || chain[0].channels == 4;
+        const BlockFormat format = !compress ? BlockFormat::None : !alpha ? BlockFormat::BC1 : bc3 ? BlockFormat::BC3 : BlockFormat::BC7;
+        std::vector<std::vector<unsigned char>> blocks;
+        std::vector<CookedLevelData> levels;
+        size_t rawBytes = 0, storedBytes = 0;
+        for (const MipImage& level : chain)
+        {
+            rawBytes += level.pixels.size();
+            if (format == BlockFormat::None)
+            {
+                levels.push_back({level.width, level.height, level.pixels.data(), level.pixels.size()});
+                continue;
+            }
+            blocks.push_back(compressImage(level, format, &pool));
+            levels.push_back({level.width, level.height, blocks.back().data(), blocks.back().size()});
+        }
+        for (const CookedLevelData& level : levels)
+            storedBytes += level.size;
+        if (!writeCookedTexture(output.string(), chain[0].channels, format, levels, CookedTextureHeader::FLIPPED))
+        {
+            ++failures;
+            continue;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "texcook: " << source.filename().string() << " -> " << output.filename().string() << " ("
+                  << chain[0].width << "x" << chain[0].height << "x" << chain[0].channels << ", "
+                  << chain.size() << " levels, " << ms << " ms)";
+        if (format != BlockFormat::None)
+        {
+            const char* names[] = {"", "BC1", "", "BC3", "", "", "", "BC7"};
+            MipImage decoded = decompressImage(blocks[0].data(), chain[0].width, chain[0].height, format);
+            std::cout << " " << names[(int)format] << " " << rawBytes << " -> " << storedBytes
+                      << " bytes, PSNR " << psnr(chain[0], decoded) << " dB";
+        }
+        std::cout << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}